@@ -4,7 +4,7 @@
 #
 #-------------------------------------------------
 
-QT += core gui webengine webenginewidgets webchannel xml positioning
+QT += core gui network webengine webenginewidgets webchannel xml positioning concurrent
 
 CONFIG += c++11
 
@@ -26,6 +26,16 @@ win32{
     LIBS += User32.Lib
 }
 
+# function names in the GUI watchdog backtraces
+linux: QMAKE_LFLAGS += -rdynamic
+
+# org.freedesktop.Notifications backend
+linux{
+    QT += dbus
+    SOURCES += freedesktopnotifier.cpp
+    HEADERS += freedesktopnotifier.h
+}
+
 # The following define makes your compiler emit warnings if you use
 # any Qt feature that has been marked deprecated (the exact warnings
 # depend on your compiler). Refer to the documentation for the
@@ -50,42 +60,84 @@ SOURCES += \
         SunClock.cpp \
         about.cpp \
         automatictheme.cpp \
+        avatarcache.cpp \
+        chromiumflags.cpp \
+        crashrecovery.cpp \
         dictionaries.cpp \
+        downloaddeduplicator.cpp \
+        downloaditemdelegate.cpp \
+        downloadlistmodel.cpp \
         downloadmanagerwidget.cpp \
-        downloadwidget.cpp \
-        elidedlabel.cpp \
+        downloadqueue.cpp \
+        downloadresumer.cpp \
+        downloadrules.cpp \
+        guiwatchdog.cpp \
         lock.cpp \
         main.cpp \
         mainwindow.cpp \
+        notificationcoalescer.cpp \
+        notificationmanager.cpp \
+        pagebridge.cpp \
+        pagehealthmonitor.cpp \
+        pagelifecyclemanager.cpp \
+        pagestatebridge.cpp \
         permissiondialog.cpp \
         rateapp.cpp \
+        recoveryladder.cpp \
+        resourcemonitor.cpp \
         rungaurd.cpp \
         settingswidget.cpp \
+        startuptracer.cpp \
+        terminalserver.cpp \
+        transferrate.cpp \
+        traybadge.cpp \
         utils.cpp \
         webenginepage.cpp \
         webview.cpp \
         widgets/scrolltext/scrolltext.cpp
 
 RESOURCES += \
-        icons.qrc
+        icons.qrc \
+        scripts.qrc
 
 HEADERS += \
     SunClock.hpp \
     about.h \
     automatictheme.h \
+    avatarcache.h \
+    chromiumflags.h \
     common.h \
+    crashrecovery.h \
     dictionaries.h \
+    downloaddeduplicator.h \
+    downloaditemdelegate.h \
+    downloadlistmodel.h \
     downloadmanagerwidget.h \
-    downloadwidget.h \
-    elidedlabel.h \
+    downloadqueue.h \
+    downloadresumer.h \
+    downloadrules.h \
+    guiwatchdog.h \
+    lazywidget.h \
     lock.h \
     mainwindow.h \
+    notificationcoalescer.h \
+    notificationmanager.h \
     notificationpopup.h \
+    pagebridge.h \
+    pagehealthmonitor.h \
+    pagelifecyclemanager.h \
+    pagestatebridge.h \
     permissiondialog.h \
     rateapp.h \
+    recoveryladder.h \
     requestinterceptor.h \
+    resourcemonitor.h \
     rungaurd.h \
     settingswidget.h \
+    startuptracer.h \
+    terminalserver.h \
+    transferrate.h \
+    traybadge.h \
     utils.h \
     webenginepage.h \
     webview.h \
@@ -97,7 +149,7 @@ FORMS += \
     automatictheme.ui \
     certificateerrordialog.ui \
     downloadmanagerwidget.ui \
-    downloadwidget.ui \
+    downloadrulesdialog.ui \
     lock.ui \
     passworddialog.ui \
     permissiondialog.ui \
@@ -0,0 +1,72 @@
+#include "avatarcache.h"
+
+#include <QFutureWatcher>
+#include <QtConcurrent>
+
+AvatarCache::AvatarCache(int maxBytes, QObject *parent)
+    : QObject(parent),
+      m_cache(maxBytes)
+{
+}
+
+quint64 AvatarCache::keyFor(const QImage &image, int height)
+{
+    const uchar *bits = image.constBits();
+    const size_t size = size_t(image.sizeInBytes());
+    // two 32 bit hashes with different seeds, the target height is part of the key
+    const uint low  = qHashBits(bits, size, uint(height));
+    const uint high = qHashBits(bits, size, uint(height) ^ 0x9e3779b9u ^ uint(image.width() << 16));
+    return (quint64(high) << 32) | low;
+}
+
+QString AvatarCache::statsText() const
+{
+    const int requests = m_hits + m_misses + m_joined;
+    return tr("Avatar cache: %1 % hits (%2 hits, %3 scaled, %4 joined), %5 KiB")
+            .arg(requests > 0 ? 100 * (m_hits + m_joined) / requests : 0)
+            .arg(m_hits).arg(m_misses).arg(m_joined)
+            .arg(m_cache.totalCost() / 1024);
+}
+
+void AvatarCache::request(const QImage &image, int height, QObject *context, Callback done)
+{
+    if (image.isNull()) {
+        done(Avatar());
+        return;
+    }
+
+    const quint64 key = keyFor(image, height);
+    if (Avatar *cached = m_cache.object(key)) {
+        ++m_hits;
+        done(*cached);
+        return;
+    }
+
+    auto pending = m_pending.find(key);
+    if (pending != m_pending.end()) {
+        ++m_joined;
+        pending->append({context, done});
+        return;
+    }
+
+    ++m_misses;
+    m_pending.insert(key, {{context, done}});
+
+    QFutureWatcher<QImage> *watcher = new QFutureWatcher<QImage>(this);
+    connect(watcher, &QFutureWatcher<QImage>::finished, this, [=]() {
+        watcher->deleteLater();
+        // QPixmap may only be created on the GUI thread
+        Avatar *avatar = new Avatar{watcher->result(), QPixmap::fromImage(watcher->result())};
+        const Avatar result = *avatar;
+        m_cache.insert(key, avatar, qMax(1, int(result.image.sizeInBytes()) * 2));
+
+        const QVector<Waiter> waiters = m_pending.take(key);
+        for (const Waiter &waiter : waiters) {
+            if (waiter.context)
+                waiter.done(result);
+        }
+    });
+    watcher->setFuture(QtConcurrent::run([image, height]() {
+        return image.scaledToHeight(height, Qt::SmoothTransformation);
+    }));
+}
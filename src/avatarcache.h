@@ -0,0 +1,55 @@
+#ifndef AVATARCACHE_H
+#define AVATARCACHE_H
+
+#include <QCache>
+#include <QHash>
+#include <QImage>
+#include <QObject>
+#include <QPixmap>
+#include <QPointer>
+#include <QVector>
+
+#include <functional>
+
+// Scaled notification avatars, keyed by a hash of the image content so the
+// same contact hits the cache no matter which notification carried the
+// image. Bounded by bytes. Misses are scaled on the QtConcurrent pool, a
+// second request for an image already being scaled waits for that result.
+class AvatarCache : public QObject
+{
+    Q_OBJECT
+
+public:
+    // the pixmap for widgets, the image for D-Bus image-data
+    struct Avatar {
+        QImage image;
+        QPixmap pixmap;
+    };
+    using Callback = std::function<void(const Avatar &)>;
+
+    explicit AvatarCache(int maxBytes = 4 * 1024 * 1024, QObject *parent = nullptr);
+
+    // Calls done with image scaled to height: right away on a hit, later on
+    // the GUI thread otherwise, not at all once context is gone.
+    void request(const QImage &image, int height, QObject *context, Callback done);
+
+    int hits() const { return m_hits; }
+    int misses() const { return m_misses; }
+    QString statsText() const;
+
+private:
+    struct Waiter {
+        QPointer<QObject> context;
+        Callback done;
+    };
+
+    static quint64 keyFor(const QImage &image, int height);
+
+    QCache<quint64, Avatar> m_cache;
+    QHash<quint64, QVector<Waiter>> m_pending;
+    int m_hits = 0;
+    int m_misses = 0;
+    int m_joined = 0;
+};
+
+#endif // AVATARCACHE_H
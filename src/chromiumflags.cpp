@@ -0,0 +1,144 @@
+#include "chromiumflags.h"
+
+#include <QDebug>
+#include <QSettings>
+
+namespace
+{
+    QString switchName(const QString &flag)
+    {
+        int eq = flag.indexOf('=');
+        return eq == -1 ? flag : flag.left(eq);
+    }
+
+    QString switchValue(const QString &flag)
+    {
+        int eq = flag.indexOf('=');
+        return eq == -1 ? QString() : flag.mid(eq + 1);
+    }
+
+    // comma separated feature lists are combined instead of replaced
+    bool isFeatureList(const QString &name)
+    {
+        return name == "--enable-features" || name == "--disable-features";
+    }
+
+    // the variable as the user started us, before apply() replaced it
+    bool environmentSaved = false;
+    bool environmentWasSet = false;
+    QByteArray environmentValue;
+}
+
+QStringList ChromiumFlags::presetNames()
+{
+    return QStringList() << "balanced" << "low-memory" << "low-cpu";
+}
+
+QString ChromiumFlags::presetTitle(const QString &preset)
+{
+    if (preset == "low-memory")
+        return QObject::tr("Low memory");
+    if (preset == "low-cpu")
+        return QObject::tr("Low CPU");
+    return QObject::tr("Balanced");
+}
+
+QStringList ChromiumFlags::presetFlags(const QString &preset)
+{
+    QStringList flags;
+    if (preset == "low-memory") {
+        flags << "--renderer-process-limit=1"
+              << "--process-per-site"
+              << "--js-flags=--max-old-space-size=256"
+              << "--disable-smooth-scrolling";
+    } else if (preset == "low-cpu") {
+        flags << "--enable-features=IntensiveWakeUpThrottling"
+              // don't fall back to rasterizing on the CPU when the GPU is unusable
+              << "--disable-software-rasterizer"
+              << "--disable-smooth-scrolling";
+    }
+    return flags;
+}
+
+QString ChromiumFlags::currentPreset()
+{
+    QSettings settings;
+    QString preset = settings.value("engine/preset","balanced").toString();
+    return presetNames().contains(preset) ? preset : QString("balanced");
+}
+
+QStringList ChromiumFlags::customFlags(const QString &preset)
+{
+    QSettings settings;
+    return settings.value("engine/customFlags/" + preset).toString()
+            .split(' ', QString::SkipEmptyParts);
+}
+
+QStringList ChromiumFlags::merge(const QStringList &base, const QStringList &overrides)
+{
+    QStringList merged = base;
+    for (const QString &flag : overrides) {
+        bool remove = flag.startsWith('!');
+        QString effective = remove ? flag.mid(1) : flag;
+        QString name = switchName(effective);
+
+        int existing = -1;
+        for (int i = 0; i < merged.size(); ++i) {
+            if (switchName(merged.at(i)) == name) {
+                existing = i;
+                break;
+            }
+        }
+
+        if (remove) {
+            if (existing != -1)
+                merged.removeAt(existing);
+        } else if (existing == -1) {
+            merged.append(effective);
+        } else if (isFeatureList(name)) {
+            QStringList features = switchValue(merged.at(existing)).split(',', QString::SkipEmptyParts);
+            for (const QString &feature : switchValue(effective).split(',', QString::SkipEmptyParts)) {
+                if (!features.contains(feature))
+                    features.append(feature);
+            }
+            merged[existing] = name + "=" + features.join(',');
+        } else {
+            merged[existing] = effective;
+        }
+    }
+    return merged;
+}
+
+void ChromiumFlags::apply(const QStringList &extraFlags)
+{
+    const QString preset = currentPreset();
+
+    if (!environmentSaved) {
+        environmentSaved = true;
+        environmentWasSet = qEnvironmentVariableIsSet("QTWEBENGINE_CHROMIUM_FLAGS");
+        environmentValue = qgetenv("QTWEBENGINE_CHROMIUM_FLAGS");
+    }
+
+    QStringList flags = presetFlags(preset);
+    flags = merge(flags, extraFlags);
+    flags = merge(flags, customFlags(preset));
+    // flags set by hand in the environment have the last word
+    flags = merge(flags, QString::fromLocal8Bit(environmentValue)
+                  .split(' ', QString::SkipEmptyParts));
+
+    if (flags.isEmpty())
+        return;
+
+    qputenv("QTWEBENGINE_CHROMIUM_FLAGS", flags.join(' ').toLocal8Bit());
+    qWarning() << "Engine preset" << preset << "chromium flags:" << flags;
+}
+
+void ChromiumFlags::restoreEnvironment()
+{
+    if (!environmentSaved)
+        return;
+    if (environmentWasSet)
+        qputenv("QTWEBENGINE_CHROMIUM_FLAGS", environmentValue);
+    else
+        qunsetenv("QTWEBENGINE_CHROMIUM_FLAGS");
+}
@@ -0,0 +1,33 @@
+#ifndef CHROMIUMFLAGS_H
+#define CHROMIUMFLAGS_H
+
+#include <QStringList>
+
+// Chromium command line presets, injected through QTWEBENGINE_CHROMIUM_FLAGS.
+// The engine reads the variable once, so apply() has to run in main() before
+// QApplication is constructed and a changed preset needs a restart.
+//
+// Flags are merged by switch name, later sources win:
+// preset < extra flags (e.g. terminal server) < custom overrides < environment.
+// A custom override of the form "!--switch" removes that switch.
+class ChromiumFlags
+{
+public:
+    static QStringList presetNames();
+    static QString presetTitle(const QString &preset);
+    static QStringList presetFlags(const QString &preset);
+
+    static QString currentPreset();
+    static QStringList customFlags(const QString &preset);
+
+    static QStringList merge(const QStringList &base, const QStringList &overrides);
+
+    // Must be called after the organization and application names are set.
+    static void apply(const QStringList &extraFlags = QStringList());
+    // Puts the variable back as it was before apply(). A restarted instance
+    // inherits the environment and would otherwise take the merged flags of
+    // this one as user flags, which override any preset change.
+    static void restoreEnvironment();
+};
+
+#endif // CHROMIUMFLAGS_H
@@ -0,0 +1,148 @@
+#include "crashrecovery.h"
+
+#include "chromiumflags.h"
+
+#include <QDebug>
+
+namespace
+{
+    const int initialDelayMs  = 1000;
+    const int maximumDelayMs  = 5 * 60 * 1000;
+    // a page alive this long after a reload resets the backoff
+    const int stableAfterMs   = 2 * 60 * 1000;
+    const int keptExitCodes   = 5;
+    const int keptLogEntries  = 20;
+    const char *fallbackPreset = "low-memory";
+
+    QString statusName(QWebEnginePage::RenderProcessTerminationStatus status)
+    {
+        switch (status) {
+        case QWebEnginePage::NormalTerminationStatus:
+            return QStringLiteral("normal");
+        case QWebEnginePage::AbnormalTerminationStatus:
+            return QStringLiteral("abnormal");
+        case QWebEnginePage::CrashedTerminationStatus:
+            return QStringLiteral("crashed");
+        case QWebEnginePage::KilledTerminationStatus:
+            return QStringLiteral("killed");
+        }
+        return QString();
+    }
+}
+
+CrashRecovery::CrashRecovery(QObject *parent)
+    : QObject(parent)
+{
+    m_reloadTimer.setSingleShot(true);
+    m_stableTimer.setSingleShot(true);
+    m_stableTimer.setInterval(stableAfterMs);
+
+    connect(&m_reloadTimer, &QTimer::timeout, this, &CrashRecovery::reloadRequested);
+    connect(&m_stableTimer, &QTimer::timeout, this, [=](){
+        m_consecutiveCrashes = 0;
+    });
+}
+
+int CrashRecovery::sessionCrashCount() const
+{
+    return m_sessionCrashes;
+}
+
+QList<int> CrashRecovery::lastExitCodes() const
+{
+    return m_lastExitCodes;
+}
+
+QString CrashRecovery::statsText() const
+{
+    QString fallback;
+    const QString fallbackFrom = settings.value("crashRecovery/fallbackFrom").toString();
+    if (!fallbackFrom.isEmpty() && ChromiumFlags::currentPreset() == fallbackPreset)
+        fallback = "\n" + tr("Engine preset switched from %1 to %2 after a crash loop")
+                .arg(ChromiumFlags::presetTitle(fallbackFrom))
+                .arg(ChromiumFlags::presetTitle(fallbackPreset));
+
+    if (m_sessionCrashes == 0)
+        return tr("No renderer crashes in this session") + fallback;
+
+    QStringList codes;
+    for (int code : m_lastExitCodes)
+        codes.append(QString::number(code));
+    return tr("Renderer crashes in this session: %1, last exit codes: %2")
+            .arg(m_sessionCrashes)
+            .arg(codes.join(", ")) + fallback;
+}
+
+void CrashRecovery::renderProcessTerminated(QWebEnginePage::RenderProcessTerminationStatus status,
+                                            int exitCode)
+{
+    m_stableTimer.stop();
+
+    // a clean exit is not a crash, just bring the page back
+    if (status == QWebEnginePage::NormalTerminationStatus) {
+        qDebug() << "Render process exited normally, reloading";
+        m_reloadTimer.start(0);
+        return;
+    }
+
+    const QList<QDateTime> recent = recordCrash(status, exitCode);
+
+    const int loopCrashes = settings.value("crashRecovery/loopCrashes", 3).toInt();
+    if (loopCrashes > 0 && recent.size() >= loopCrashes
+            && ChromiumFlags::currentPreset() != fallbackPreset) {
+        const QString previousPreset = ChromiumFlags::currentPreset();
+        qWarning() << "Renderer crash loop," << recent.size()
+                   << "crashes, falling back from the" << previousPreset
+                   << "to the" << fallbackPreset << "preset";
+        // kept so the switch can be explained and undone in the settings
+        settings.setValue("crashRecovery/fallbackFrom", previousPreset);
+        settings.setValue("engine/preset", fallbackPreset);
+        settings.remove("crashRecovery/log");
+        m_reloadTimer.stop();
+        emit crashLoopDetected(fallbackPreset);
+        return;
+    }
+
+    const int shift = qMin(m_consecutiveCrashes, 16);
+    const int delay = int(qMin<qint64>(qint64(initialDelayMs) << shift, maximumDelayMs));
+    ++m_consecutiveCrashes;
+
+    qWarning() << "Render process" << statusName(status) << "with code" << exitCode
+               << "reloading in" << delay << "ms";
+    m_reloadTimer.start(delay);
+}
+
+void CrashRecovery::pageLoaded(bool ok)
+{
+    if (ok && m_consecutiveCrashes > 0 && !m_stableTimer.isActive())
+        m_stableTimer.start();
+}
+
+// Appends to the persisted crash log and returns the crashes inside the loop window.
+QList<QDateTime> CrashRecovery::recordCrash(QWebEnginePage::RenderProcessTerminationStatus status,
+                                            int exitCode)
+{
+    ++m_sessionCrashes;
+    m_lastExitCodes.append(exitCode);
+    while (m_lastExitCodes.size() > keptExitCodes)
+        m_lastExitCodes.removeFirst();
+
+    const QDateTime now = QDateTime::currentDateTimeUtc();
+    const int windowMinutes = settings.value("crashRecovery/loopWindowMinutes", 10).toInt();
+
+    // entries are "<ISO time> <status> <exit code>"
+    QStringList log = settings.value("crashRecovery/log").toStringList();
+    log.append(QString("%1 %2 %3").arg(now.toString(Qt::ISODate), statusName(status))
+               .arg(exitCode));
+    while (log.size() > keptLogEntries)
+        log.removeFirst();
+    settings.setValue("crashRecovery/log", log);
+
+    QList<QDateTime> recent;
+    for (const QString &entry : qAsConst(log)) {
+        QDateTime when = QDateTime::fromString(entry.section(' ', 0, 0), Qt::ISODate);
+        if (when.isValid() && when.secsTo(now) <= windowMinutes * 60)
+            recent.append(when);
+    }
+    return recent;
+}
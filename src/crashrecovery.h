@@ -0,0 +1,52 @@
+#ifndef CRASHRECOVERY_H
+#define CRASHRECOVERY_H
+
+#include <QDateTime>
+#include <QObject>
+#include <QSettings>
+#include <QTimer>
+#include <QWebEnginePage>
+
+// Brings the page back after the renderer died (OOM killer, GPU reset, ...)
+// without asking the user. Reloads are delayed with exponential backoff,
+// the backoff resets once a page survived for a while.
+//
+// Every crash is also appended to a log kept in the settings, so a crash
+// loop is noticed across restarts: after loopCrashes crashes within
+// loopWindowMinutes the engine is switched to the low-memory preset and a
+// restart is requested.
+class CrashRecovery : public QObject
+{
+    Q_OBJECT
+
+public:
+    explicit CrashRecovery(QObject *parent = nullptr);
+
+    int sessionCrashCount() const;
+    QList<int> lastExitCodes() const;
+    QString statsText() const;
+
+public slots:
+    void renderProcessTerminated(QWebEnginePage::RenderProcessTerminationStatus status,
+                                 int exitCode);
+    // page came back and loaded fine
+    void pageLoaded(bool ok);
+
+signals:
+    void reloadRequested();
+    void crashLoopDetected(const QString &fallbackPreset);
+
+private:
+    QList<QDateTime> recordCrash(QWebEnginePage::RenderProcessTerminationStatus status,
+                                 int exitCode);
+
+    QSettings settings;
+    QTimer m_reloadTimer;
+    QTimer m_stableTimer;
+
+    int m_sessionCrashes = 0;
+    int m_consecutiveCrashes = 0;
+    QList<int> m_lastExitCodes;
+};
+
+#endif // CRASHRECOVERY_H
@@ -0,0 +1,194 @@
+#include "downloaddeduplicator.h"
+
+#include <QCryptographicHash>
+#include <QDebug>
+#include <QFileInfo>
+#include <QFutureWatcher>
+#include <QtConcurrent>
+
+#ifdef Q_OS_WIN
+#include <windows.h>
+#else
+#include <unistd.h>
+#endif
+
+namespace
+{
+    struct HashResult {
+        qint64 size = -1;
+        QByteArray hash;
+    };
+
+    HashResult hashFile(const QString &path)
+    {
+        HashResult result;
+        QFile file(path);
+        if (!file.open(QIODevice::ReadOnly))
+            return result;
+        QCryptographicHash hash(QCryptographicHash::Sha256);
+        // reads in blocks, the file is never held in memory as a whole
+        if (!hash.addData(&file))
+            return result;
+        result.size = file.size();
+        result.hash = hash.result().toHex();
+        return result;
+    }
+
+    bool sameContent(const QString &path, const QString &otherPath)
+    {
+        QFile file(path);
+        QFile other(otherPath);
+        if (!file.open(QIODevice::ReadOnly) || !other.open(QIODevice::ReadOnly)
+                || file.size() != other.size())
+            return false;
+        while (!file.atEnd()) {
+            const QByteArray block = file.read(1 << 16);
+            if (block.isEmpty() || block != other.read(block.size()))
+                return false;
+        }
+        return true;
+    }
+
+    // swaps path for a hard link to existingPath, leaves path alone on failure
+    bool replaceWithLink(const QString &path, const QString &existingPath)
+    {
+        const QString temporary = path + ".dedup";
+        QFile::remove(temporary);
+#ifdef Q_OS_WIN
+        bool linked = CreateHardLinkW(reinterpret_cast<LPCWSTR>(temporary.utf16()),
+                                      reinterpret_cast<LPCWSTR>(existingPath.utf16()), nullptr);
+#else
+        bool linked = ::link(QFile::encodeName(existingPath).constData(),
+                             QFile::encodeName(temporary).constData()) == 0;
+#endif
+        if (!linked)
+            return false;
+        if (!QFile::remove(path) || !QFile::rename(temporary, path)) {
+            QFile::remove(temporary);
+            return false;
+        }
+        return true;
+    }
+
+    enum class Outcome { Replaced, Differs, Failed };
+
+    // runs on the worker, the index may be stale so the files are compared first
+    Outcome replaceDuplicate(const QString &path, const QString &existingPath, bool link)
+    {
+        if (!sameContent(path, existingPath))
+            return Outcome::Differs;
+        const bool replaced = link ? replaceWithLink(path, existingPath) : QFile::remove(path);
+        return replaced ? Outcome::Replaced : Outcome::Failed;
+    }
+}
+
+DownloadDeduplicator::DownloadDeduplicator(const QString &indexPath, QObject *parent)
+    : QObject(parent),
+      m_indexPath(indexPath),
+      m_index(indexPath)
+{
+    m_pool.setMaxThreadCount(1);
+}
+
+DownloadDeduplicator::~DownloadDeduplicator()
+{
+    m_pool.clear();
+    m_pool.waitForDone();
+}
+
+void DownloadDeduplicator::check(qint64 id, const QString &path)
+{
+    if (settings.value("downloads/duplicates", "keep").toString() == "keep")
+        return;
+
+    QFutureWatcher<HashResult> *watcher = new QFutureWatcher<HashResult>(this);
+    connect(watcher, &QFutureWatcher<HashResult>::finished, this, [=]() {
+        watcher->deleteLater();
+        const HashResult result = watcher->result();
+        if (result.size < 0) {
+            qWarning() << "Unable to hash download" << path;
+            return;
+        }
+        hashed(id, path, result.size, result.hash);
+    });
+    watcher->setFuture(QtConcurrent::run(&m_pool, hashFile, path));
+}
+
+void DownloadDeduplicator::hashed(qint64 id, const QString &path, qint64 size, const QByteArray &hash)
+{
+    if (!m_indexLoaded)
+        loadIndex();
+
+    auto existing = m_entries.find(hash);
+    if (existing != m_entries.end() && existing->path != path) {
+        const QFileInfo info(existing->path);
+        // the earlier copy was moved, deleted or changed since
+        if (!info.exists() || info.size() != existing->size) {
+            m_entries.erase(existing);
+            existing = m_entries.end();
+        }
+    }
+
+    if (existing == m_entries.end() || existing->path == path) {
+        const Entry entry{size, path};
+        m_entries.insert(hash, entry);
+        appendToIndex(hash, entry);
+        return;
+    }
+
+    const QString existingPath = existing->path;
+    const QString mode = settings.value("downloads/duplicates", "keep").toString();
+    if (mode != "hardlink" && mode != "remove")
+        return;
+
+    QFutureWatcher<Outcome> *watcher = new QFutureWatcher<Outcome>(this);
+    connect(watcher, &QFutureWatcher<Outcome>::finished, this, [=]() {
+        watcher->deleteLater();
+        switch (watcher->result()) {
+        case Outcome::Replaced:
+            emit duplicateFound(id, path, existingPath);
+            break;
+        case Outcome::Differs: {
+            // the earlier copy was rewritten in place, this one takes its hash
+            const Entry entry{size, path};
+            m_entries.insert(hash, entry);
+            appendToIndex(hash, entry);
+            break;
+        }
+        case Outcome::Failed:
+            qWarning() << "Unable to replace duplicate" << path << "of" << existingPath;
+            break;
+        }
+    });
+    watcher->setFuture(QtConcurrent::run(&m_pool, replaceDuplicate, path, existingPath,
+                                         mode == "hardlink"));
+}
+
+void DownloadDeduplicator::loadIndex()
+{
+    m_indexLoaded = true;
+    QFile file(m_indexPath);
+    if (!file.open(QIODevice::ReadOnly))
+        return;
+    while (!file.atEnd()) {
+        // hash size path, the path may contain spaces
+        const QByteArray line = file.readLine().trimmed();
+        const int first = line.indexOf(' ');
+        const int second = line.indexOf(' ', first + 1);
+        if (first == -1 || second == -1)
+            continue;
+        m_entries.insert(line.left(first),
+                         Entry{line.mid(first + 1, second - first - 1).toLongLong(),
+                               QString::fromUtf8(line.mid(second + 1))});
+    }
+}
+
+void DownloadDeduplicator::appendToIndex(const QByteArray &hash, const Entry &entry)
+{
+    if (!m_index.isOpen() && !m_index.open(QIODevice::WriteOnly | QIODevice::Append)) {
+        qWarning() << "Unable to write download hashes" << m_indexPath << m_index.errorString();
+        return;
+    }
+    m_index.write(hash + ' ' + QByteArray::number(entry.size) + ' ' + entry.path.toUtf8() + '\n');
+    m_index.flush();
+}
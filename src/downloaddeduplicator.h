@@ -0,0 +1,50 @@
+#ifndef DOWNLOADDEDUPLICATOR_H
+#define DOWNLOADDEDUPLICATOR_H
+
+#include <QFile>
+#include <QHash>
+#include <QObject>
+#include <QSettings>
+#include <QThreadPool>
+
+// Hashes finished downloads (SHA-256) on a worker thread and keeps the
+// hashes in a small index file, one "hash size path" line per file. When a
+// new download has the same content as a file saved earlier, the new copy
+// is replaced by a hard link to it or removed, per "downloads/duplicates"
+// (hardlink, remove or keep). Nothing is hashed with "keep", the default.
+// The index only nominates the earlier copy; both files are compared byte
+// by byte on the worker before the new one is touched.
+class DownloadDeduplicator : public QObject
+{
+    Q_OBJECT
+
+public:
+    explicit DownloadDeduplicator(const QString &indexPath, QObject *parent = nullptr);
+    ~DownloadDeduplicator();
+
+    void check(qint64 id, const QString &path);
+
+signals:
+    // path was a copy of existingPath and has been linked to it or removed
+    void duplicateFound(qint64 id, const QString &path, const QString &existingPath);
+
+private:
+    struct Entry {
+        qint64 size;
+        QString path;
+    };
+
+    void hashed(qint64 id, const QString &path, qint64 size, const QByteArray &hash);
+    void loadIndex();
+    void appendToIndex(const QByteArray &hash, const Entry &entry);
+
+    QSettings settings;
+    QString m_indexPath;
+    QFile m_index;
+    bool m_indexLoaded = false;
+    QHash<QByteArray, Entry> m_entries;
+    // one file at a time, hashing is disk bound
+    QThreadPool m_pool;
+};
+
+#endif // DOWNLOADDEDUPLICATOR_H
@@ -0,0 +1,110 @@
+#include "downloaditemdelegate.h"
+#include "downloadlistmodel.h"
+
+#include <QApplication>
+#include <QMouseEvent>
+#include <QPainter>
+#include <QStyleOptionProgressBar>
+
+namespace
+{
+    const int margin = 6;
+    const int buttonSize = 22;
+}
+
+DownloadItemDelegate::DownloadItemDelegate(QObject *parent)
+    : QStyledItemDelegate(parent),
+      m_stopIcon(QStringLiteral(":/icons/stop-line.png")),
+      m_removeIcon(QStringLiteral(":/icons/close-fill.png"))
+{
+}
+
+QRect DownloadItemDelegate::buttonRect(const QRect &itemRect) const
+{
+    return QRect(itemRect.right() - margin - buttonSize, itemRect.top() + margin, buttonSize, buttonSize);
+}
+
+QSize DownloadItemDelegate::sizeHint(const QStyleOptionViewItem &option, const QModelIndex &) const
+{
+    // the same for every row, the view runs with uniformItemSizes
+    const int lineHeight = option.fontMetrics.height();
+    return QSize(300, 3 * margin + 2 * lineHeight + qMax(lineHeight + 4, 18) + margin);
+}
+
+void DownloadItemDelegate::paint(QPainter *painter, const QStyleOptionViewItem &option,
+                                 const QModelIndex &index) const
+{
+    QStyleOptionViewItem opt = option;
+    initStyleOption(&opt, index);
+    const QWidget *widget = option.widget;
+    QStyle *style = widget ? widget->style() : QApplication::style();
+
+    // background, selection and focus only
+    opt.text.clear();
+    opt.icon = QIcon();
+    style->drawControl(QStyle::CE_ItemViewItem, &opt, painter, widget);
+
+    const QRect rect = option.rect;
+    const int lineHeight = option.fontMetrics.height();
+    const bool active = index.data(DownloadListModel::ActiveRole).toBool();
+    const int textRight = buttonRect(rect).left() - margin;
+
+    painter->save();
+    painter->setPen(option.palette.color(option.state & QStyle::State_Selected ? QPalette::HighlightedText
+                                                                                 : QPalette::Text));
+
+    QFont bold = option.font;
+    bold.setBold(true);
+    painter->setFont(bold);
+    QRect nameRect(rect.left() + margin, rect.top() + margin, textRight - rect.left() - margin, lineHeight);
+    painter->drawText(nameRect, Qt::AlignLeft | Qt::AlignVCenter,
+                      QFontMetrics(bold).elidedText(index.data(Qt::DisplayRole).toString(),
+                                                    Qt::ElideMiddle, nameRect.width()));
+
+    painter->setFont(option.font);
+    QRect urlRect = nameRect.translated(0, lineHeight + margin / 2);
+    painter->drawText(urlRect, Qt::AlignLeft | Qt::AlignVCenter,
+                      option.fontMetrics.elidedText(index.data(DownloadListModel::UrlRole).toUrl().toDisplayString(),
+                                                    Qt::ElideRight, urlRect.width()));
+    painter->restore();
+
+    QStyleOptionProgressBar bar;
+    bar.rect = QRect(rect.left() + margin, urlRect.bottom() + margin,
+                     rect.width() - 2 * margin, qMax(lineHeight + 4, 18));
+    bar.palette = option.palette;
+    bar.fontMetrics = option.fontMetrics;
+    bar.state = option.state & ~QStyle::State_HasFocus;
+    if (!active)
+        bar.state &= ~QStyle::State_Enabled;
+    bar.minimum = 0;
+    bar.maximum = 100;
+    const qint64 total = index.data(DownloadListModel::TotalBytesRole).toLongLong();
+    const qint64 received = index.data(DownloadListModel::ReceivedBytesRole).toLongLong();
+    const int state = index.data(DownloadListModel::StateRole).toInt();
+    if (state == QWebEngineDownloadItem::DownloadCompleted)
+        bar.progress = 100;
+    else if (state == QWebEngineDownloadItem::DownloadInProgress && total > 0)
+        bar.progress = int(100 * received / total);
+    else
+        bar.progress = 0;
+    bar.text = index.data(DownloadListModel::StatusTextRole).toString();
+    bar.textVisible = true;
+    bar.textAlignment = Qt::AlignCenter;
+    style->drawControl(QStyle::CE_ProgressBar, &bar, painter, widget);
+
+    const QIcon &icon = active ? m_stopIcon : m_removeIcon;
+    icon.paint(painter, buttonRect(rect).adjusted(3, 3, -3, -3));
+}
+
+bool DownloadItemDelegate::editorEvent(QEvent *event, QAbstractItemModel *model,
+                                       const QStyleOptionViewItem &option, const QModelIndex &index)
+{
+    if (event->type() == QEvent::MouseButtonRelease) {
+        QMouseEvent *mouseEvent = static_cast<QMouseEvent *>(event);
+        if (mouseEvent->button() == Qt::LeftButton && buttonRect(option.rect).contains(mouseEvent->pos())) {
+            emit buttonClicked(index);
+            return true;
+        }
+    }
+    return QStyledItemDelegate::editorEvent(event, model, option, index);
+}
@@ -0,0 +1,35 @@
+#ifndef DOWNLOADITEMDELEGATE_H
+#define DOWNLOADITEMDELEGATE_H
+
+#include <QIcon>
+#include <QStyledItemDelegate>
+
+// Paints a download row: file name, source url, progress bar and a
+// stop/remove button, without any child widgets per row.
+class DownloadItemDelegate : public QStyledItemDelegate
+{
+    Q_OBJECT
+
+public:
+    explicit DownloadItemDelegate(QObject *parent = nullptr);
+
+    void paint(QPainter *painter, const QStyleOptionViewItem &option,
+               const QModelIndex &index) const override;
+    QSize sizeHint(const QStyleOptionViewItem &option, const QModelIndex &index) const override;
+
+signals:
+    // the stop/remove button of a row was clicked
+    void buttonClicked(const QModelIndex &index);
+
+protected:
+    bool editorEvent(QEvent *event, QAbstractItemModel *model,
+                     const QStyleOptionViewItem &option, const QModelIndex &index) override;
+
+private:
+    QRect buttonRect(const QRect &itemRect) const;
+
+    QIcon m_stopIcon;
+    QIcon m_removeIcon;
+};
+
+#endif // DOWNLOADITEMDELEGATE_H
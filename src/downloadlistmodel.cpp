@@ -0,0 +1,484 @@
+#include "downloadlistmodel.h"
+
+#include <QDebug>
+#include <QFileInfo>
+#include <QHash>
+#include <QJsonDocument>
+#include <QLocale>
+#include <QSaveFile>
+
+#include <algorithm>
+
+namespace
+{
+    // rows handed to the view per fetchMore()
+    const int fetchBatch = 100;
+    // progress repaints per second, however often the engine reports
+    const int progressHz = 10;
+
+    QString formatTimeLeft(qint64 seconds)
+    {
+        if (seconds < 60)
+            return DownloadListModel::tr("%1 s left").arg(seconds);
+        if (seconds < 3600)
+            return DownloadListModel::tr("%1 min left").arg((seconds + 30) / 60);
+        return DownloadListModel::tr("%1 h %2 min left").arg(seconds / 3600).arg(seconds % 3600 / 60);
+    }
+}
+
+bool DownloadRecord::isActive() const
+{
+    return item && state == QWebEngineDownloadItem::DownloadInProgress;
+}
+
+QJsonObject DownloadRecord::toJson() const
+{
+    QJsonObject object;
+    object.insert("id", QString::number(id));
+    object.insert("path", path);
+    object.insert("url", url.toString());
+    object.insert("mime", mimeType);
+    object.insert("total", totalBytes);
+    object.insert("received", receivedBytes);
+    object.insert("state", int(state));
+    if (!interruptReason.isEmpty())
+        object.insert("reason", interruptReason);
+    if (!duplicateOf.isEmpty())
+        object.insert("duplicateOf", duplicateOf);
+    object.insert("started", started.toMSecsSinceEpoch());
+    if (finished.isValid())
+        object.insert("finished", finished.toMSecsSinceEpoch());
+    return object;
+}
+
+DownloadRecord DownloadRecord::fromJson(const QJsonObject &object)
+{
+    DownloadRecord record;
+    record.id = object.value("id").toString().toLongLong();
+    record.path = object.value("path").toString();
+    record.url = QUrl(object.value("url").toString());
+    record.mimeType = object.value("mime").toString();
+    record.totalBytes = qint64(object.value("total").toDouble(-1));
+    record.receivedBytes = qint64(object.value("received").toDouble());
+    record.state = QWebEngineDownloadItem::DownloadState(object.value("state").toInt());
+    record.interruptReason = object.value("reason").toString();
+    record.duplicateOf = object.value("duplicateOf").toString();
+    record.started = QDateTime::fromMSecsSinceEpoch(qint64(object.value("started").toDouble()));
+    if (object.contains("finished"))
+        record.finished = QDateTime::fromMSecsSinceEpoch(qint64(object.value("finished").toDouble()));
+    return record;
+}
+
+DownloadListModel::DownloadListModel(const QString &journalPath, QObject *parent)
+    : QAbstractListModel(parent),
+      m_journalPath(journalPath),
+      m_journal(journalPath)
+{
+    m_progressTimer.setInterval(1000 / progressHz);
+    connect(&m_progressTimer, &QTimer::timeout, this, &DownloadListModel::sampleProgress);
+    m_clock.start();
+}
+
+int DownloadListModel::rowCount(const QModelIndex &parent) const
+{
+    return parent.isValid() ? 0 : m_rows.size();
+}
+
+QVariant DownloadListModel::data(const QModelIndex &index, int role) const
+{
+    if (!index.isValid() || index.row() >= m_rows.size())
+        return QVariant();
+
+    const DownloadRecord &record = m_rows.at(index.row());
+    switch (role) {
+    case Qt::DisplayRole:
+        return QFileInfo(record.path).fileName();
+    case Qt::ToolTipRole:
+        return record.path;
+    case IdRole:
+        return record.id;
+    case PathRole:
+        return record.path;
+    case UrlRole:
+        return record.url;
+    case StateRole:
+        return int(record.state);
+    case ReceivedBytesRole:
+        return record.receivedBytes;
+    case TotalBytesRole:
+        return record.totalBytes;
+    case StatusTextRole:
+        if (record.statusText.isNull())
+            record.statusText = statusText(record);
+        return record.statusText;
+    case ActiveRole:
+        return record.isActive();
+    }
+    return QVariant();
+}
+
+bool DownloadListModel::canFetchMore(const QModelIndex &parent) const
+{
+    if (parent.isValid())
+        return false;
+    return !m_historyLoaded || !m_unfetched.isEmpty();
+}
+
+void DownloadListModel::fetchMore(const QModelIndex &parent)
+{
+    if (parent.isValid())
+        return;
+    if (!m_historyLoaded)
+        loadHistory();
+
+    const int count = qMin(fetchBatch, m_unfetched.size());
+    if (count == 0)
+        return;
+    beginInsertRows(QModelIndex(), m_rows.size(), m_rows.size() + count - 1);
+    for (int i = 0; i < count; ++i)
+        m_rows.append(m_unfetched.at(i));
+    m_unfetched.remove(0, count);
+    endInsertRows();
+}
+
+qint64 DownloadListModel::addDownload(QWebEngineDownloadItem *download, qint64 replacesId)
+{
+    DownloadRecord record;
+    if (replacesId != 0) {
+        record.id = replacesId;
+        const int row = rowOf(replacesId);
+        if (row != -1) {
+            beginRemoveRows(QModelIndex(), row, row);
+            m_rows.remove(row);
+            endRemoveRows();
+        }
+        m_unfetched.erase(std::remove_if(m_unfetched.begin(), m_unfetched.end(),
+                                         [=](const DownloadRecord &old) { return old.id == replacesId; }),
+                          m_unfetched.end());
+    } else {
+        record.id = qMax(QDateTime::currentMSecsSinceEpoch(), m_lastId + 1);
+        m_lastId = record.id;
+    }
+    record.path = download->path();
+    record.url = download->url();
+    record.mimeType = download->mimeType();
+    record.totalBytes = download->totalBytes();
+    record.receivedBytes = download->receivedBytes();
+    record.state = download->state();
+    record.started = QDateTime::currentDateTime();
+    record.item = download;
+
+    const qint64 id = record.id;
+    connect(download, &QWebEngineDownloadItem::stateChanged, this, [=]() { itemStateChanged(id); });
+
+    beginInsertRows(QModelIndex(), 0, 0);
+    m_rows.prepend(record);
+    endInsertRows();
+
+    if (record.state == QWebEngineDownloadItem::DownloadInProgress)
+        track(id);
+
+    appendToJournal(record.toJson());
+    emit activeCountChanged(activeCount());
+    return id;
+}
+
+void DownloadListModel::cancelOrRemove(int row)
+{
+    if (row < 0 || row >= m_rows.size())
+        return;
+
+    DownloadRecord &record = m_rows[row];
+    if (record.isActive()) {
+        record.item->cancel();
+        return;
+    }
+
+    QJsonObject entry;
+    entry.insert("id", QString::number(record.id));
+    entry.insert("removed", true);
+    appendToJournal(entry);
+
+    beginRemoveRows(QModelIndex(), row, row);
+    m_rows.remove(row);
+    endRemoveRows();
+}
+
+const DownloadRecord &DownloadListModel::record(int row) const
+{
+    return m_rows.at(row);
+}
+
+int DownloadListModel::activeCount() const
+{
+    return int(std::count_if(m_rows.cbegin(), m_rows.cend(),
+                             [](const DownloadRecord &record) { return record.isActive(); }));
+}
+
+QSet<QString> DownloadListModel::activePaths() const
+{
+    QSet<QString> paths;
+    for (const DownloadRecord &record : m_rows) {
+        if (record.isActive())
+            paths.insert(record.path);
+    }
+    return paths;
+}
+
+void DownloadListModel::setDuplicateOf(qint64 id, const QString &existingPath)
+{
+    const int row = rowOf(id);
+    if (row == -1)
+        return;
+    DownloadRecord &record = m_rows[row];
+    record.duplicateOf = existingPath;
+    record.statusText.clear();
+    appendToJournal(record.toJson());
+
+    const QModelIndex changed = index(row);
+    emit dataChanged(changed, changed);
+}
+
+void DownloadListModel::setNote(qint64 id, const QString &note)
+{
+    const int row = rowOf(id);
+    if (row == -1)
+        return;
+    m_rows[row].note = note;
+    m_rows[row].statusText.clear();
+
+    const QModelIndex changed = index(row);
+    emit dataChanged(changed, changed, {StatusTextRole});
+}
+
+QString DownloadListModel::withUnit(qreal bytes)
+{
+    if (bytes < (1 << 10))
+        return tr("%L1 B").arg(bytes);
+    else if (bytes < (1 << 20))
+        return tr("%L1 KiB").arg(bytes / (1 << 10), 0, 'f', 2);
+    else if (bytes < (1 << 30))
+        return tr("%L1 MiB").arg(bytes / (1 << 20), 0, 'f', 2);
+    else
+        return tr("%L1 GiB").arg(bytes / (1 << 30), 0, 'f', 2);
+}
+
+void DownloadListModel::itemStateChanged(qint64 id)
+{
+    const int row = rowOf(id);
+    if (row == -1)
+        return;
+
+    DownloadRecord &record = m_rows[row];
+    if (record.item.isNull())
+        return;
+
+    const QWebEngineDownloadItem::DownloadState previousState = record.state;
+    record.totalBytes = record.item->totalBytes();
+    record.receivedBytes = record.item->receivedBytes();
+    record.state = record.item->state();
+    if (record.state == QWebEngineDownloadItem::DownloadInterrupted)
+        record.interruptReason = record.item->interruptReasonString();
+
+    record.statusText.clear();
+
+    if (record.state != previousState) {
+        record.note.clear();
+        if (record.state == QWebEngineDownloadItem::DownloadInProgress) {
+            track(id);
+        } else {
+            record.finished = QDateTime::currentDateTime();
+            m_rates.remove(id);
+        }
+        appendToJournal(record.toJson());
+        emit activeCountChanged(activeCount());
+    }
+
+    const QModelIndex changed = index(row);
+    emit dataChanged(changed, changed);
+
+    if (record.state != previousState && record.state == QWebEngineDownloadItem::DownloadCompleted)
+        emit downloadCompleted(id, record.path);
+}
+
+void DownloadListModel::track(qint64 id)
+{
+    m_rates.insert(id, TransferRate());
+    if (!m_progressTimer.isActive())
+        m_progressTimer.start();
+}
+
+void DownloadListModel::sampleProgress()
+{
+    const qint64 now = m_clock.elapsed();
+    int firstChanged = -1, lastChanged = -1;
+    int found = 0;
+    QVector<qint64> gone;
+
+    // running downloads sit at the top, stop once all of them were seen
+    for (int row = 0; row < m_rows.size() && found < m_rates.size(); ++row) {
+        DownloadRecord &record = m_rows[row];
+        auto rate = m_rates.find(record.id);
+        if (rate == m_rates.end())
+            continue;
+        ++found;
+        if (record.item.isNull()) {
+            gone.append(record.id);
+            continue;
+        }
+
+        record.receivedBytes = record.item->receivedBytes();
+        record.totalBytes = record.item->totalBytes();
+        rate->addSample(now, record.receivedBytes);
+
+        // the speed moves even when no bytes arrive
+        record.statusText.clear();
+        if (firstChanged == -1)
+            firstChanged = row;
+        lastChanged = row;
+    }
+
+    if (firstChanged != -1) {
+        emit dataChanged(index(firstChanged), index(lastChanged),
+                         {ReceivedBytesRole, TotalBytesRole, StatusTextRole});
+    }
+    for (qint64 id : qAsConst(gone))
+        m_rates.remove(id);
+    if (m_rates.isEmpty())
+        m_progressTimer.stop();
+}
+
+int DownloadListModel::rowOf(qint64 id) const
+{
+    for (int row = 0; row < m_rows.size(); ++row) {
+        if (m_rows.at(row).id == id)
+            return row;
+    }
+    return -1;
+}
+
+QString DownloadListModel::statusText(const DownloadRecord &record) const
+{
+    switch (record.state) {
+    case QWebEngineDownloadItem::DownloadRequested:
+        return QString();
+    case QWebEngineDownloadItem::DownloadInProgress: {
+        // held back by the download queue
+        if (record.item && record.item->isPaused())
+            return tr("queued - %1").arg(withUnit(record.totalBytes > 0 ? record.totalBytes : 0));
+        const auto rate = m_rates.constFind(record.id);
+        const qreal bytesPerSecond = rate != m_rates.constEnd() ? rate->bytesPerSecond() : -1;
+        const QString speed = bytesPerSecond < 0 ? QStringLiteral("-") : withUnit(bytesPerSecond);
+        if (record.totalBytes > 0) {
+            const qint64 secondsLeft = rate != m_rates.constEnd()
+                    ? rate->secondsLeft(record.totalBytes - record.receivedBytes) : -1;
+            return tr("%1% - %2 of %3 downloaded - %4/s%5")
+                    .arg(qRound(100.0 * record.receivedBytes / record.totalBytes))
+                    .arg(withUnit(record.receivedBytes))
+                    .arg(withUnit(record.totalBytes))
+                    .arg(speed)
+                    .arg(secondsLeft < 0 ? QString() : " - " + formatTimeLeft(secondsLeft));
+        }
+        return tr("unknown size - %1 downloaded - %2/s")
+                .arg(withUnit(record.receivedBytes))
+                .arg(speed);
+    }
+    case QWebEngineDownloadItem::DownloadCompleted:
+        if (!record.duplicateOf.isEmpty())
+            return tr("already saved at %1").arg(record.duplicateOf);
+        return tr("completed - %1 downloaded - %2")
+                .arg(withUnit(record.receivedBytes))
+                .arg(QLocale::system().toString(record.finished, QLocale::ShortFormat));
+    case QWebEngineDownloadItem::DownloadCancelled:
+        return tr("cancelled - %1 downloaded")
+                .arg(withUnit(record.receivedBytes));
+    case QWebEngineDownloadItem::DownloadInterrupted:
+        if (!record.note.isEmpty())
+            return tr("interrupted: %1 - %2").arg(record.interruptReason).arg(record.note);
+        return tr("interrupted: %1").arg(record.interruptReason);
+    }
+    return QString();
+}
+
+void DownloadListModel::loadHistory()
+{
+    m_historyLoaded = true;
+
+    QFile file(m_journalPath);
+    if (!file.open(QIODevice::ReadOnly))
+        return;
+
+    // later lines update earlier ones with the same id
+    QVector<DownloadRecord> records;
+    QHash<qint64, int> indexOf;
+    int lines = 0;
+    while (!file.atEnd()) {
+        const QByteArray line = file.readLine().trimmed();
+        if (line.isEmpty())
+            continue;
+        ++lines;
+        const QJsonObject object = QJsonDocument::fromJson(line).object();
+        const qint64 id = object.value("id").toString().toLongLong();
+        if (id == 0)
+            continue;
+        if (object.value("removed").toBool()) {
+            if (indexOf.contains(id))
+                records[indexOf.value(id)].id = 0;
+            continue;
+        }
+        if (indexOf.contains(id))
+            records[indexOf.value(id)] = DownloadRecord::fromJson(object);
+        else {
+            indexOf.insert(id, records.size());
+            records.append(DownloadRecord::fromJson(object));
+        }
+    }
+    file.close();
+
+    records.erase(std::remove_if(records.begin(), records.end(),
+                                 [](const DownloadRecord &record) { return record.id == 0; }),
+                  records.end());
+    std::sort(records.begin(), records.end(), [](const DownloadRecord &a, const DownloadRecord &b) {
+        return a.id > b.id;
+    });
+
+    if (lines > 2 * records.size() + 64)
+        compactJournal(records);
+
+    for (DownloadRecord &record : records) {
+        m_lastId = qMax(m_lastId, record.id);
+        // this session's downloads are rows already
+        if (rowOf(record.id) != -1)
+            continue;
+        if (record.state == QWebEngineDownloadItem::DownloadInProgress) {
+            record.state = QWebEngineDownloadItem::DownloadInterrupted;
+            record.interruptReason = tr("the application was closed");
+        }
+        m_unfetched.append(record);
+    }
+}
+
+void DownloadListModel::appendToJournal(const QJsonObject &entry)
+{
+    if (!m_journal.isOpen() && !m_journal.open(QIODevice::WriteOnly | QIODevice::Append)) {
+        qWarning() << "Unable to write download history" << m_journalPath << m_journal.errorString();
+        return;
+    }
+    m_journal.write(QJsonDocument(entry).toJson(QJsonDocument::Compact) + '\n');
+    m_journal.flush();
+}
+
+// rewrites the journal with one line per entry, dropping updates and removals;
+// this session's downloads were journaled too, so records has them
+void DownloadListModel::compactJournal(const QVector<DownloadRecord> &records)
+{
+    m_journal.close();
+
+    QSaveFile file(m_journalPath);
+    if (!file.open(QIODevice::WriteOnly))
+        return;
+    for (auto it = records.crbegin(); it != records.crend(); ++it)
+        file.write(QJsonDocument(it->toJson()).toJson(QJsonDocument::Compact) + '\n');
+    if (!file.commit())
+        qWarning() << "Unable to compact download history" << file.errorString();
+}
@@ -0,0 +1,126 @@
+#ifndef DOWNLOADLISTMODEL_H
+#define DOWNLOADLISTMODEL_H
+
+#include <QAbstractListModel>
+#include <QDateTime>
+#include <QElapsedTimer>
+#include <QFile>
+#include <QHash>
+#include <QJsonObject>
+#include <QPointer>
+#include <QSet>
+#include <QTimer>
+#include <QUrl>
+#include <QVector>
+#include <QWebEngineDownloadItem>
+
+#include "transferrate.h"
+
+// One row of the download list, a running download or a history entry.
+struct DownloadRecord
+{
+    qint64 id = 0;
+    QString path;
+    QUrl url;
+    QString mimeType;
+    qint64 totalBytes = -1;
+    qint64 receivedBytes = 0;
+    QWebEngineDownloadItem::DownloadState state = QWebEngineDownloadItem::DownloadInProgress;
+    QString interruptReason;
+    // an earlier download with the same content
+    QString duplicateOf;
+    // not saved in the journal
+    QString note;
+    QDateTime started;
+    QDateTime finished;
+    // only set while the download runs in this session
+    QPointer<QWebEngineDownloadItem> item;
+    // built on demand, cleared whenever the fields above change
+    mutable QString statusText;
+
+    bool isActive() const;
+    QJsonObject toJson() const;
+    static DownloadRecord fromJson(const QJsonObject &object);
+};
+
+// Downloads for a QListView, newest first. Every added or finished download
+// is appended to a JSON lines journal in the "downloads" data folder. The
+// journal is parsed as a whole the first time the view asks for rows
+// (fetchMore), i.e. when the download manager is first shown, not at
+// startup; the parsed history is then handed to the view a page at a time,
+// so only rows scrolled to get created.
+//
+// Running downloads are not followed signal by signal: their progress is
+// sampled at a fixed rate and all changed rows go out in one dataChanged().
+class DownloadListModel : public QAbstractListModel
+{
+    Q_OBJECT
+
+public:
+    enum Roles {
+        IdRole = Qt::UserRole + 1,
+        PathRole,
+        UrlRole,
+        StateRole,
+        ReceivedBytesRole,
+        TotalBytesRole,
+        StatusTextRole,
+        ActiveRole
+    };
+
+    explicit DownloadListModel(const QString &journalPath, QObject *parent = nullptr);
+
+    int rowCount(const QModelIndex &parent = QModelIndex()) const override;
+    QVariant data(const QModelIndex &index, int role = Qt::DisplayRole) const override;
+    bool canFetchMore(const QModelIndex &parent) const override;
+    void fetchMore(const QModelIndex &parent) override;
+
+    // Precondition: the download has been accepted. A download requested
+    // again for an interrupted one passes its id and takes over its row.
+    qint64 addDownload(QWebEngineDownloadItem *download, qint64 replacesId = 0);
+    // cancels a running download, removes any other row from the list and journal
+    void cancelOrRemove(int row);
+
+    const DownloadRecord &record(int row) const;
+    int activeCount() const;
+    // target files of running downloads, they may not exist on disk yet
+    QSet<QString> activePaths() const;
+
+    void setDuplicateOf(qint64 id, const QString &existingPath);
+    // shown after the reason of an interrupted download, e.g. the next retry
+    void setNote(qint64 id, const QString &note);
+
+    static QString withUnit(qreal bytes);
+
+signals:
+    void activeCountChanged(int count);
+    void downloadCompleted(qint64 id, const QString &path);
+
+private:
+    void itemStateChanged(qint64 id);
+    void sampleProgress();
+    void track(qint64 id);
+    int rowOf(qint64 id) const;
+    QString statusText(const DownloadRecord &record) const;
+
+    void loadHistory();
+    void appendToJournal(const QJsonObject &entry);
+    void compactJournal(const QVector<DownloadRecord> &records);
+
+    QString m_journalPath;
+    QFile m_journal;
+    // rows as shown; running downloads are inserted at the top, so they are
+    // found within the first few entries by rowOf()
+    QVector<DownloadRecord> m_rows;
+    // parsed history the view has not asked for yet, newest first
+    QVector<DownloadRecord> m_unfetched;
+    bool m_historyLoaded = false;
+    qint64 m_lastId = 0;
+
+    // running downloads by id, sampled by m_progressTimer
+    QHash<qint64, TransferRate> m_rates;
+    QTimer m_progressTimer;
+    QElapsedTimer m_clock;
+};
+
+#endif // DOWNLOADLISTMODEL_H
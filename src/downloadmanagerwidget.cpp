@@ -1,50 +1,113 @@
-#include "downloadmanagerwidget.h"
-
-#include "downloadwidget.h"
-
-#include <QFileDialog>
-#include <QWebEngineDownloadItem>
-
-DownloadManagerWidget::DownloadManagerWidget(QWidget *parent)
-    : QWidget(parent)
-    , m_numDownloads(0)
-{
-    setupUi(this);
-}
-
-void DownloadManagerWidget::downloadRequested(QWebEngineDownloadItem *download)
-{
-    Q_ASSERT(download && download->state() == QWebEngineDownloadItem::DownloadRequested);
-    QString path;
-
-    bool usenativeFileDialog = settings.value("useNativeFileDialog",false).toBool();
-    if(usenativeFileDialog == false){
-        path = QFileDialog::getSaveFileName(this, tr("Save as"), download->path(),tr("Any file (*)"),nullptr,QFileDialog::DontUseNativeDialog);
-    }else{
-        path = QFileDialog::getSaveFileName(this, tr("Save as"), download->path(),tr("Any file (*)"),nullptr);
-    }
-
-    if (path.isEmpty())
-        return;
-
-    download->setPath(path);
-    download->accept();
-    add(new DownloadWidget(download));
-    show();
-}
-
-void DownloadManagerWidget::add(DownloadWidget *downloadWidget)
-{
-    connect(downloadWidget, &DownloadWidget::removeClicked, this, &DownloadManagerWidget::remove);
-    m_itemsLayout->insertWidget(0, downloadWidget, 0, Qt::AlignTop);
-    if (m_numDownloads++ == 0)
-        m_zeroItemsLabel->hide();
-}
-
-void DownloadManagerWidget::remove(DownloadWidget *downloadWidget)
-{
-    m_itemsLayout->removeWidget(downloadWidget);
-    downloadWidget->deleteLater();
-    if (--m_numDownloads == 0)
-        m_zeroItemsLabel->show();
-}
+#include "downloadmanagerwidget.h"
+
+#include "downloaddeduplicator.h"
+#include "downloaditemdelegate.h"
+#include "downloadlistmodel.h"
+#include "downloadqueue.h"
+#include "downloadresumer.h"
+#include "utils.h"
+
+#include <QDir>
+#include <QFileDialog>
+#include <QFileInfo>
+#include <QWebEngineDownloadItem>
+
+DownloadManagerWidget::DownloadManagerWidget(QWidget *parent)
+    : QWidget(parent)
+{
+    setupUi(this);
+
+    m_model = new DownloadListModel(utils::returnPath("downloads") + "history.jsonl", this);
+    DownloadItemDelegate *delegate = new DownloadItemDelegate(m_listView);
+    m_listView->setItemDelegate(delegate);
+    m_listView->setModel(m_model);
+    m_queue = new DownloadQueue(this);
+    m_deduplicator = new DownloadDeduplicator(utils::returnPath("downloads") + "hashes.txt", this);
+    connect(m_model, &DownloadListModel::downloadCompleted, m_deduplicator, &DownloadDeduplicator::check);
+    connect(m_deduplicator, &DownloadDeduplicator::duplicateFound, this,
+            [=](qint64 id, const QString &, const QString &existingPath) {
+        m_model->setDuplicateOf(id, existingPath);
+    });
+
+    m_resumer = new DownloadResumer(this);
+    connect(m_resumer, &DownloadResumer::retryScheduled, this, [=](qint64 id, int seconds) {
+        m_model->setNote(id, seconds < 0 ? tr("gave up retrying") : tr("retrying in %1 s").arg(seconds));
+    });
+
+    connect(delegate, &DownloadItemDelegate::buttonClicked, this, [=](const QModelIndex &index) {
+        // a removed row is not retried anymore
+        if (!m_model->record(index.row()).isActive())
+            m_resumer->forget(m_model->record(index.row()).id);
+        m_model->cancelOrRemove(index.row());
+    });
+    connect(m_model, &QAbstractItemModel::rowsInserted, this, &DownloadManagerWidget::updateZeroItemsLabel);
+    connect(m_model, &QAbstractItemModel::rowsRemoved, this, &DownloadManagerWidget::updateZeroItemsLabel);
+    updateZeroItemsLabel();
+}
+
+void DownloadManagerWidget::downloadRequested(QWebEngineDownloadItem *download, const QString &sourceChat)
+{
+    Q_ASSERT(download && download->state() == QWebEngineDownloadItem::DownloadRequested);
+    QString path;
+
+    const DownloadResumer::Restart restart = m_resumer->takeRestart(download->url());
+    if (restart.id != 0) {
+        // an interrupted download requested again, same file as before
+        path = restart.path;
+    } else if (settings.value("downloads/autoSave", false).toBool()) {
+        m_rules.load(settings);
+        const DownloadRules::Decision decision = m_rules.decide(download->mimeType(), sourceChat);
+        const QString fileName = QFileInfo(download->path()).fileName();
+        if (decision.ask) {
+            path = askForPath(QDir(decision.folder).filePath(fileName));
+        } else {
+            QDir().mkpath(decision.folder);
+            path = DownloadRules::uniqueFilePath(decision.folder, fileName, m_model->activePaths());
+        }
+    } else {
+        path = askForPath(download->path());
+    }
+
+    if (path.isEmpty())
+        return;
+
+    download->setPath(path);
+    download->accept();
+    const qint64 id = m_model->addDownload(download, restart.id);
+    m_resumer->watch(id, download);
+    m_queue->reloadSettings();
+    m_queue->add(download);
+    // retries happen in the background
+    if (restart.id == 0)
+        show();
+}
+
+void DownloadManagerWidget::setPage(QWebEnginePage *page)
+{
+    m_resumer->setPage(page);
+}
+
+QString DownloadManagerWidget::askForPath(const QString &suggestedPath)
+{
+    bool usenativeFileDialog = settings.value("useNativeFileDialog",false).toBool();
+    if(usenativeFileDialog == false){
+        return QFileDialog::getSaveFileName(this, tr("Save as"), suggestedPath,tr("Any file (*)"),nullptr,QFileDialog::DontUseNativeDialog);
+    }else{
+        return QFileDialog::getSaveFileName(this, tr("Save as"), suggestedPath,tr("Any file (*)"),nullptr);
+    }
+}
+
+void DownloadManagerWidget::showEvent(QShowEvent *event)
+{
+    QWidget::showEvent(event);
+    // the history is read the first time the list is looked at
+    if (m_model->canFetchMore(QModelIndex()))
+        m_model->fetchMore(QModelIndex());
+}
+
+void DownloadManagerWidget::updateZeroItemsLabel()
+{
+    const bool empty = m_model->rowCount() == 0;
+    m_zeroItemsLabel->setVisible(empty);
+    m_listView->setVisible(!empty);
+}
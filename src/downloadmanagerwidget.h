@@ -1,85 +1,104 @@
-/****************************************************************************
-**
-** Copyright (C) 2017 The Qt Company Ltd.
-** Contact: https://www.qt.io/licensing/
-**
-** This file is part of the examples of the Qt Toolkit.
-**
-** $QT_BEGIN_LICENSE:BSD$
-** Commercial License Usage
-** Licensees holding valid commercial Qt licenses may use this file in
-** accordance with the commercial license agreement provided with the
-** Software or, alternatively, in accordance with the terms contained in
-** a written agreement between you and The Qt Company. For licensing terms
-** and conditions see https://www.qt.io/terms-conditions. For further
-** information use the contact form at https://www.qt.io/contact-us.
-**
-** BSD License Usage
-** Alternatively, you may use this file under the terms of the BSD license
-** as follows:
-**
-** "Redistribution and use in source and binary forms, with or without
-** modification, are permitted provided that the following conditions are
-** met:
-**   * Redistributions of source code must retain the above copyright
-**     notice, this list of conditions and the following disclaimer.
-**   * Redistributions in binary form must reproduce the above copyright
-**     notice, this list of conditions and the following disclaimer in
-**     the documentation and/or other materials provided with the
-**     distribution.
-**   * Neither the name of The Qt Company Ltd nor the names of its
-**     contributors may be used to endorse or promote products derived
-**     from this software without specific prior written permission.
-**
-**
-** THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS
-** "AS IS" AND ANY EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT
-** LIMITED TO, THE IMPLIED WARRANTIES OF MERCHANTABILITY AND FITNESS FOR
-** A PARTICULAR PURPOSE ARE DISCLAIMED. IN NO EVENT SHALL THE COPYRIGHT
-** OWNER OR CONTRIBUTORS BE LIABLE FOR ANY DIRECT, INDIRECT, INCIDENTAL,
-** SPECIAL, EXEMPLARY, OR CONSEQUENTIAL DAMAGES (INCLUDING, BUT NOT
-** LIMITED TO, PROCUREMENT OF SUBSTITUTE GOODS OR SERVICES; LOSS OF USE,
-** DATA, OR PROFITS; OR BUSINESS INTERRUPTION) HOWEVER CAUSED AND ON ANY
-** THEORY OF LIABILITY, WHETHER IN CONTRACT, STRICT LIABILITY, OR TORT
-** (INCLUDING NEGLIGENCE OR OTHERWISE) ARISING IN ANY WAY OUT OF THE USE
-** OF THIS SOFTWARE, EVEN IF ADVISED OF THE POSSIBILITY OF SUCH DAMAGE."
-**
-** $QT_END_LICENSE$
-**
-****************************************************************************/
-
-#ifndef DOWNLOADMANAGERWIDGET_H
-#define DOWNLOADMANAGERWIDGET_H
-
-#include "ui_downloadmanagerwidget.h"
-
-#include <QWidget>
-#include <QSettings>
-
-QT_BEGIN_NAMESPACE
-class QWebEngineDownloadItem;
-QT_END_NAMESPACE
-
-class DownloadWidget;
-
-// Displays a list of downloads.
-class DownloadManagerWidget final : public QWidget, public Ui::DownloadManagerWidget
-{
-    Q_OBJECT
-public:
-    explicit DownloadManagerWidget(QWidget *parent = nullptr);
-
-    // Prompts user with a "Save As" dialog. If the user doesn't cancel it, then
-    // the QWebEngineDownloadItem will be accepted and the DownloadManagerWidget
-    // will be shown on the screen.
-    void downloadRequested(QWebEngineDownloadItem *webItem);
-
-private:
-    void add(DownloadWidget *downloadWidget);
-    void remove(DownloadWidget *downloadWidget);
-
-    int m_numDownloads;
-    QSettings settings;
-};
-
-#endif // DOWNLOADMANAGERWIDGET_H
+/****************************************************************************
+**
+** Copyright (C) 2017 The Qt Company Ltd.
+** Contact: https://www.qt.io/licensing/
+**
+** This file is part of the examples of the Qt Toolkit.
+**
+** $QT_BEGIN_LICENSE:BSD$
+** Commercial License Usage
+** Licensees holding valid commercial Qt licenses may use this file in
+** accordance with the commercial license agreement provided with the
+** Software or, alternatively, in accordance with the terms contained in
+** a written agreement between you and The Qt Company. For licensing terms
+** and conditions see https://www.qt.io/terms-conditions. For further
+** information use the contact form at https://www.qt.io/contact-us.
+**
+** BSD License Usage
+** Alternatively, you may use this file under the terms of the BSD license
+** as follows:
+**
+** "Redistribution and use in source and binary forms, with or without
+** modification, are permitted provided that the following conditions are
+** met:
+**   * Redistributions of source code must retain the above copyright
+**     notice, this list of conditions and the following disclaimer.
+**   * Redistributions in binary form must reproduce the above copyright
+**     notice, this list of conditions and the following disclaimer in
+**     the documentation and/or other materials provided with the
+**     distribution.
+**   * Neither the name of The Qt Company Ltd nor the names of its
+**     contributors may be used to endorse or promote products derived
+**     from this software without specific prior written permission.
+**
+**
+** THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS
+** "AS IS" AND ANY EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT
+** LIMITED TO, THE IMPLIED WARRANTIES OF MERCHANTABILITY AND FITNESS FOR
+** A PARTICULAR PURPOSE ARE DISCLAIMED. IN NO EVENT SHALL THE COPYRIGHT
+** OWNER OR CONTRIBUTORS BE LIABLE FOR ANY DIRECT, INDIRECT, INCIDENTAL,
+** SPECIAL, EXEMPLARY, OR CONSEQUENTIAL DAMAGES (INCLUDING, BUT NOT
+** LIMITED TO, PROCUREMENT OF SUBSTITUTE GOODS OR SERVICES; LOSS OF USE,
+** DATA, OR PROFITS; OR BUSINESS INTERRUPTION) HOWEVER CAUSED AND ON ANY
+** THEORY OF LIABILITY, WHETHER IN CONTRACT, STRICT LIABILITY, OR TORT
+** (INCLUDING NEGLIGENCE OR OTHERWISE) ARISING IN ANY WAY OUT OF THE USE
+** OF THIS SOFTWARE, EVEN IF ADVISED OF THE POSSIBILITY OF SUCH DAMAGE."
+**
+** $QT_END_LICENSE$
+**
+****************************************************************************/
+
+#ifndef DOWNLOADMANAGERWIDGET_H
+#define DOWNLOADMANAGERWIDGET_H
+
+#include "ui_downloadmanagerwidget.h"
+
+#include <QWidget>
+#include <QSettings>
+
+#include "downloadrules.h"
+
+QT_BEGIN_NAMESPACE
+class QWebEngineDownloadItem;
+class QWebEnginePage;
+QT_END_NAMESPACE
+
+class DownloadDeduplicator;
+class DownloadListModel;
+class DownloadQueue;
+class DownloadResumer;
+
+// Displays a list of downloads, including the history of earlier sessions.
+class DownloadManagerWidget final : public QWidget, public Ui::DownloadManagerWidget
+{
+    Q_OBJECT
+public:
+    explicit DownloadManagerWidget(QWidget *parent = nullptr);
+
+    // With "downloads/autoSave" the file goes where DownloadRules say, and
+    // sourceChat is the chat it came from. Otherwise, or when a rule says
+    // "ask", prompts user with a "Save As" dialog. If the user doesn't cancel
+    // it, then the QWebEngineDownloadItem will be accepted, queued and the
+    // DownloadManagerWidget will be shown on the screen.
+    void downloadRequested(QWebEngineDownloadItem *webItem, const QString &sourceChat = QString());
+
+    // page that interrupted downloads are requested again from
+    void setPage(QWebEnginePage *page);
+
+protected:
+    void showEvent(QShowEvent *event) override;
+
+private:
+    void updateZeroItemsLabel();
+
+    QString askForPath(const QString &suggestedPath);
+
+    DownloadListModel *m_model;
+    DownloadQueue *m_queue;
+    DownloadDeduplicator *m_deduplicator;
+    DownloadResumer *m_resumer;
+    DownloadRules m_rules;
+    QSettings settings;
+};
+
+#endif // DOWNLOADMANAGERWIDGET_H
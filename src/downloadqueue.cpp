@@ -0,0 +1,105 @@
+#include "downloadqueue.h"
+
+#include <QWebEngineDownloadItem>
+
+#include <algorithm>
+
+DownloadQueue::DownloadQueue(QObject *parent)
+    : QObject(parent)
+{
+    reloadSettings();
+}
+
+void DownloadQueue::reloadSettings()
+{
+    m_maxConcurrent = qMax(1, settings.value("downloads/maxConcurrent", 3).toInt());
+    m_priority = settings.value("downloads/priority",
+                                QStringList({"document", "image", "audio", "video"})).toStringList();
+    startNext();
+}
+
+QString DownloadQueue::category(const QString &mimeType)
+{
+    if (mimeType.startsWith("image/"))
+        return QStringLiteral("image");
+    if (mimeType.startsWith("audio/"))
+        return QStringLiteral("audio");
+    if (mimeType.startsWith("video/"))
+        return QStringLiteral("video");
+    if (mimeType.startsWith("text/") || mimeType == "application/pdf"
+            || mimeType.startsWith("application/vnd.") || mimeType.contains("document")
+            || mimeType == "application/msword" || mimeType == "application/rtf")
+        return QStringLiteral("document");
+    return QStringLiteral("other");
+}
+
+int DownloadQueue::priorityOf(const QString &mimeType) const
+{
+    const int index = m_priority.indexOf(category(mimeType));
+    return index == -1 ? m_priority.size() : index;
+}
+
+void DownloadQueue::add(QWebEngineDownloadItem *download)
+{
+    connect(download, &QWebEngineDownloadItem::stateChanged, this, [=](QWebEngineDownloadItem::DownloadState state) {
+        if (state != QWebEngineDownloadItem::DownloadInProgress)
+            finished(download);
+        // an interrupted download that was resumed needs a slot again
+        else if (!m_running.contains(download) && !isQueued(download))
+            schedule(download);
+    });
+    connect(download, &QObject::destroyed, this, [=]() { finished(download); });
+    schedule(download);
+}
+
+void DownloadQueue::schedule(QWebEngineDownloadItem *download)
+{
+    if (m_running.size() < m_maxConcurrent && m_waiting.isEmpty()) {
+        m_running.append(download);
+        return;
+    }
+
+    download->pause();
+    Waiting waiting{priorityOf(download->mimeType()), m_sequence++, download};
+    auto position = std::upper_bound(m_waiting.begin(), m_waiting.end(), waiting,
+                                     [](const Waiting &a, const Waiting &b) {
+        return a.priority < b.priority || (a.priority == b.priority && a.sequence < b.sequence);
+    });
+    m_waiting.insert(position, waiting);
+    startNext();
+}
+
+bool DownloadQueue::isQueued(const QWebEngineDownloadItem *download) const
+{
+    return std::any_of(m_waiting.cbegin(), m_waiting.cend(),
+                       [=](const Waiting &waiting) { return waiting.item == download; });
+}
+
+int DownloadQueue::runningCount() const
+{
+    return m_running.size();
+}
+
+void DownloadQueue::finished(QWebEngineDownloadItem *download)
+{
+    // also drops entries of items that are gone
+    m_running.erase(std::remove_if(m_running.begin(), m_running.end(),
+                                   [=](const QPointer<QWebEngineDownloadItem> &item) {
+        return item.isNull() || item == download;
+    }), m_running.end());
+    m_waiting.erase(std::remove_if(m_waiting.begin(), m_waiting.end(), [=](const Waiting &waiting) {
+        return waiting.item.isNull() || waiting.item == download;
+    }), m_waiting.end());
+    startNext();
+}
+
+void DownloadQueue::startNext()
+{
+    while (m_running.size() < m_maxConcurrent && !m_waiting.isEmpty()) {
+        QPointer<QWebEngineDownloadItem> next = m_waiting.takeFirst().item;
+        if (next.isNull() || next->state() != QWebEngineDownloadItem::DownloadInProgress)
+            continue;
+        m_running.append(next);
+        next->resume();
+    }
+}
@@ -0,0 +1,58 @@
+#ifndef DOWNLOADQUEUE_H
+#define DOWNLOADQUEUE_H
+
+#include <QObject>
+#include <QPointer>
+#include <QSettings>
+#include <QStringList>
+#include <QVector>
+
+QT_BEGIN_NAMESPACE
+class QWebEngineDownloadItem;
+QT_END_NAMESPACE
+
+// Limits how many downloads transfer at once ("downloads/maxConcurrent").
+// The engine cancels a download that is not accepted right away, so waiting
+// downloads are accepted and paused, and resumed in priority order as slots
+// free up. The priority comes from the MIME type category, in the order of
+// "downloads/priority" (documents first, videos last by default).
+class DownloadQueue : public QObject
+{
+    Q_OBJECT
+
+public:
+    explicit DownloadQueue(QObject *parent = nullptr);
+
+    // Precondition: the download has been accepted.
+    void add(QWebEngineDownloadItem *download);
+    void reloadSettings();
+
+    bool isQueued(const QWebEngineDownloadItem *download) const;
+    int runningCount() const;
+
+    // document, image, audio, video or other
+    static QString category(const QString &mimeType);
+
+private:
+    struct Waiting {
+        int priority;
+        quint64 sequence;
+        QPointer<QWebEngineDownloadItem> item;
+    };
+
+    int priorityOf(const QString &mimeType) const;
+    // runs the download if a slot is free, pauses and queues it otherwise
+    void schedule(QWebEngineDownloadItem *download);
+    void startNext();
+    void finished(QWebEngineDownloadItem *download);
+
+    QSettings settings;
+    int m_maxConcurrent = 3;
+    QStringList m_priority;
+    QVector<QPointer<QWebEngineDownloadItem>> m_running;
+    // sorted by priority, then arrival
+    QVector<Waiting> m_waiting;
+    quint64 m_sequence = 0;
+};
+
+#endif // DOWNLOADQUEUE_H
@@ -0,0 +1,196 @@
+#include "downloadresumer.h"
+
+#include <QDebug>
+#include <QFileInfo>
+#include <QWebEngineDownloadItem>
+#include <QWebEnginePage>
+
+namespace
+{
+    const int firstDelaySeconds = 2;
+    const int maxDelaySeconds = 5 * 60;
+
+    // blob: and data: urls only live as long as the page that made them
+    bool canRequestAgain(const QUrl &url)
+    {
+        return url.scheme() == "http" || url.scheme() == "https";
+    }
+}
+
+DownloadResumer::DownloadResumer(QObject *parent)
+    : QObject(parent)
+{
+    const int count = settings.beginReadArray("downloads/resume/pending");
+    for (int i = 0; i < count; ++i) {
+        settings.setArrayIndex(i);
+        const qint64 id = settings.value("id").toLongLong();
+        Pending &pending = m_pending[id];
+        pending.url = settings.value("url").toUrl();
+        pending.path = settings.value("path").toString();
+        pending.attempts = settings.value("attempts").toInt();
+    }
+    settings.endArray();
+}
+
+void DownloadResumer::setPage(QWebEnginePage *page)
+{
+    m_page = page;
+    if (!m_lastSessionResumed) {
+        m_lastSessionResumed = true;
+        resumeFromLastSession();
+    }
+}
+
+void DownloadResumer::resumeFromLastSession()
+{
+    const QList<qint64> ids = m_pending.keys();
+    for (qint64 id : ids) {
+        const Pending pending = m_pending.value(id);
+        if (!pending.item.isNull())
+            continue;
+        if (canRequestAgain(pending.url))
+            interrupted(id, nullptr);
+        else
+            forget(id);
+    }
+}
+
+void DownloadResumer::watch(qint64 id, QWebEngineDownloadItem *download)
+{
+    // kept while it runs, so a quit in the middle of it is picked up next time
+    Pending &pending = m_pending[id];
+    pending.item = download;
+    pending.url = download->url();
+    pending.path = download->path();
+    savePending();
+
+    connect(download, &QWebEngineDownloadItem::stateChanged, this,
+            [=](QWebEngineDownloadItem::DownloadState state) {
+        // an item that was replaced by a new request
+        auto pending = m_pending.constFind(id);
+        if (pending != m_pending.constEnd() && pending->item != download)
+            return;
+        if (state == QWebEngineDownloadItem::DownloadInterrupted)
+            interrupted(id, download);
+        else if (state == QWebEngineDownloadItem::DownloadCompleted)
+            finished(id, true);
+        else if (state == QWebEngineDownloadItem::DownloadCancelled)
+            finished(id, false);
+    });
+}
+
+void DownloadResumer::forget(qint64 id)
+{
+    if (!m_pending.contains(id))
+        return;
+    delete m_pending.take(id).timer;
+    savePending();
+}
+
+DownloadResumer::Restart DownloadResumer::takeRestart(const QUrl &url)
+{
+    Restart restart;
+    const qint64 id = m_restarts.take(url);
+    if (id != 0 && m_pending.contains(id)) {
+        restart.id = id;
+        restart.path = m_pending.value(id).path;
+    }
+    return restart;
+}
+
+void DownloadResumer::interrupted(qint64 id, QWebEngineDownloadItem *download)
+{
+    Pending &pending = m_pending[id];
+    if (download) {
+        pending.item = download;
+        pending.url = download->url();
+        pending.path = download->path();
+        qDebug() << "Download interrupted:" << download->interruptReasonString() << pending.url;
+    }
+
+    // blob: media of the web app can't be requested again, don't promise a retry
+    if (!canRequestAgain(pending.url)
+            || pending.attempts >= settings.value("downloads/resume/maxAttempts", 8).toInt()) {
+        count("gaveUp");
+        forget(id);
+        emit retryScheduled(id, -1);
+        return;
+    }
+
+    if (pending.timer == nullptr) {
+        pending.timer = new QTimer(this);
+        pending.timer->setSingleShot(true);
+        connect(pending.timer, &QTimer::timeout, this, [=]() { retry(id); });
+    }
+    const int delay = qMin(maxDelaySeconds, firstDelaySeconds << qMin(pending.attempts, 16));
+    pending.timer->start(delay * 1000);
+    savePending();
+    emit retryScheduled(id, delay);
+}
+
+void DownloadResumer::retry(qint64 id)
+{
+    auto pending = m_pending.find(id);
+    if (pending == m_pending.end())
+        return;
+    ++pending->attempts;
+    // QWebEngineDownloadItem::resume() only continues a paused item, an
+    // interrupted one is finished for the engine and its partial data is gone
+    restart(id);
+}
+
+void DownloadResumer::restart(qint64 id)
+{
+    Pending &pending = m_pending[id];
+    if (m_page.isNull() || !canRequestAgain(pending.url)) {
+        count("gaveUp");
+        forget(id);
+        emit retryScheduled(id, -1);
+        return;
+    }
+    count("restarted");
+    m_restarts.insert(pending.url, id);
+    // comes back through QWebEngineProfile::downloadRequested
+    m_page->download(pending.url, QFileInfo(pending.path).fileName());
+}
+
+void DownloadResumer::finished(qint64 id, bool completed)
+{
+    if (!m_pending.contains(id))
+        return;
+    if (completed && m_pending.value(id).attempts > 0)
+        count("recovered");
+    forget(id);
+}
+
+void DownloadResumer::savePending()
+{
+    settings.beginWriteArray("downloads/resume/pending", m_pending.size());
+    int i = 0;
+    for (auto it = m_pending.cbegin(); it != m_pending.cend(); ++it, ++i) {
+        settings.setArrayIndex(i);
+        settings.setValue("id", it.key());
+        settings.setValue("url", it->url);
+        settings.setValue("path", it->path);
+        settings.setValue("attempts", it->attempts);
+    }
+    settings.endArray();
+}
+
+void DownloadResumer::count(const char *counter)
+{
+    const QString key = QString("downloads/resume/stats/") + counter;
+    settings.setValue(key, settings.value(key, 0).toLongLong() + 1);
+}
+
+QString DownloadResumer::statsText()
+{
+    QSettings settings;
+    settings.beginGroup("downloads/resume/stats");
+    const qint64 restarted = settings.value("restarted", 0).toLongLong();
+    const qint64 recovered = settings.value("recovered", 0).toLongLong();
+    const qint64 gaveUp = settings.value("gaveUp", 0).toLongLong();
+    settings.endGroup();
+    return tr("Interrupted downloads: %1 requested again, %2 completed after a retry, %3 given up")
+            .arg(restarted).arg(recovered).arg(gaveUp);
+}
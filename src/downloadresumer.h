@@ -0,0 +1,76 @@
+#ifndef DOWNLOADRESUMER_H
+#define DOWNLOADRESUMER_H
+
+#include <QHash>
+#include <QObject>
+#include <QPointer>
+#include <QSettings>
+#include <QTimer>
+#include <QUrl>
+
+QT_BEGIN_NAMESPACE
+class QWebEngineDownloadItem;
+class QWebEnginePage;
+QT_END_NAMESPACE
+
+// Retries interrupted downloads with exponential backoff. The url is requested
+// again through the page, and the new download takes over the old row and
+// target path (see takeRestart()). Partial data is not reused: the engine
+// only resume()s a paused item, an interrupted one is finished for it and
+// starts over from zero. Running and interrupted downloads are kept in
+// "downloads/resume/pending" until they complete or are cancelled, so the
+// ones with an http(s) url are requested again after a restart.
+class DownloadResumer : public QObject
+{
+    Q_OBJECT
+
+public:
+    struct Restart {
+        qint64 id = 0;
+        QString path;
+    };
+
+    explicit DownloadResumer(QObject *parent = nullptr);
+
+    // page used to request urls again
+    void setPage(QWebEnginePage *page);
+
+    void watch(qint64 id, QWebEngineDownloadItem *download);
+    // stop retrying, e.g. the row was removed
+    void forget(qint64 id);
+
+    // a download for url that replaces an earlier one, {0, ""} if none
+    Restart takeRestart(const QUrl &url);
+
+    static QString statsText();
+
+signals:
+    // seconds until the next attempt, -1 once retrying gave up
+    void retryScheduled(qint64 id, int seconds);
+
+private:
+    struct Pending {
+        QPointer<QWebEngineDownloadItem> item;
+        QUrl url;
+        QString path;
+        int attempts = 0;
+        QTimer *timer = nullptr;
+    };
+
+    void interrupted(qint64 id, QWebEngineDownloadItem *download);
+    void retry(qint64 id);
+    void restart(qint64 id);
+    void finished(qint64 id, bool completed);
+    void resumeFromLastSession();
+    void savePending();
+    void count(const char *counter);
+
+    QSettings settings;
+    QPointer<QWebEnginePage> m_page;
+    bool m_lastSessionResumed = false;
+    QHash<qint64, Pending> m_pending;
+    // url -> id of a download that was requested again
+    QHash<QUrl, qint64> m_restarts;
+};
+
+#endif // DOWNLOADRESUMER_H
@@ -0,0 +1,111 @@
+#include "downloadrules.h"
+
+#include <QDir>
+#include <QFileInfo>
+#include <QRegularExpression>
+#include <QStandardPaths>
+
+#include <algorithm>
+
+void DownloadRules::load(QSettings &settings)
+{
+    m_defaultFolder = settings.value("downloads/folder",
+                                     QStandardPaths::writableLocation(QStandardPaths::DownloadLocation)).toString();
+
+    m_rules = read(settings);
+    for (Rule &rule : m_rules)
+        rule.expression = wildcard(rule.pattern);
+
+    // chat rules first, keeping the order within each kind
+    std::stable_sort(m_rules.begin(), m_rules.end(), [](const Rule &a, const Rule &b) {
+        return a.kind == Rule::Chat && b.kind != Rule::Chat;
+    });
+}
+
+QVector<DownloadRules::Rule> DownloadRules::read(QSettings &settings)
+{
+    QVector<Rule> rules;
+    const int count = settings.beginReadArray("downloads/rules");
+    for (int i = 0; i < count; ++i) {
+        settings.setArrayIndex(i);
+        Rule rule;
+        rule.kind = settings.value("match").toString() == "chat" ? Rule::Chat : Rule::MimeType;
+        rule.pattern = settings.value("pattern").toString();
+        rule.ask = settings.value("action", "save").toString() == "ask";
+        rule.folder = settings.value("folder").toString();
+        if (!rule.pattern.isEmpty())
+            rules.append(rule);
+    }
+    settings.endArray();
+    return rules;
+}
+
+void DownloadRules::save(QSettings &settings, const QVector<Rule> &rules)
+{
+    // beginWriteArray() keeps entries past the new size, drop the old array first
+    settings.remove("downloads/rules");
+    settings.beginWriteArray("downloads/rules", rules.size());
+    for (int i = 0; i < rules.size(); ++i) {
+        settings.setArrayIndex(i);
+        settings.setValue("match", rules.at(i).kind == Rule::Chat ? "chat" : "mime");
+        settings.setValue("pattern", rules.at(i).pattern);
+        settings.setValue("action", rules.at(i).ask ? "ask" : "save");
+        settings.setValue("folder", rules.at(i).folder);
+    }
+    settings.endArray();
+}
+
+bool DownloadRules::matches(const Rule &rule, const QString &value)
+{
+    if (value.isEmpty())
+        return false;
+    return rule.expression.match(value).hasMatch();
+}
+
+// wildcardToRegularExpression() is made for file paths, its * stops at "/"
+// and so could never span "application/pdf"
+QRegularExpression DownloadRules::wildcard(const QString &pattern)
+{
+    QString expression = QRegularExpression::escape(pattern);
+    expression.replace("\\*", ".*");
+    expression.replace("\\?", ".");
+    return QRegularExpression("\\A" + expression + "\\z", QRegularExpression::CaseInsensitiveOption);
+}
+
+DownloadRules::Decision DownloadRules::decide(const QString &mimeType, const QString &chat) const
+{
+    Decision decision;
+    decision.folder = m_defaultFolder;
+    for (const Rule &rule : m_rules) {
+        if (matches(rule, rule.kind == Rule::Chat ? chat : mimeType)) {
+            decision.ask = rule.ask;
+            if (!rule.folder.isEmpty())
+                decision.folder = rule.folder;
+            break;
+        }
+    }
+    return decision;
+}
+
+QString DownloadRules::uniqueFilePath(const QString &folder, const QString &fileName,
+                                      const QSet<QString> &reserved)
+{
+    const QDir dir(folder);
+    QString candidate = dir.filePath(fileName);
+    if (!QFileInfo::exists(candidate) && !reserved.contains(candidate))
+        return candidate;
+
+    // photo (2).jpg, archive (2).tar.gz, .hidden (2)
+    const QFileInfo info(fileName);
+    QString base = info.completeBaseName();
+    if (base.isEmpty())
+        base = fileName;
+    else if (base.endsWith(".tar", Qt::CaseInsensitive))
+        base.chop(4);
+    const QString suffix = fileName.mid(base.length());
+    for (int n = 2; ; ++n) {
+        candidate = dir.filePath(QString("%1 (%2)%3").arg(base).arg(n).arg(suffix));
+        if (!QFileInfo::exists(candidate) && !reserved.contains(candidate))
+            return candidate;
+    }
+}
@@ -0,0 +1,56 @@
+#ifndef DOWNLOADRULES_H
+#define DOWNLOADRULES_H
+
+#include <QRegularExpression>
+#include <QSet>
+#include <QSettings>
+#include <QString>
+#include <QVector>
+
+// Where a download goes without asking. Rules live in the "downloads/rules"
+// settings array, each entry with
+//   match   "mime" or "chat"
+//   pattern wildcard for the MIME type (image/*) or the chat name, * and ?
+//           also match "/"
+//   action  "save" or "ask"
+//   folder  target folder for "save", the default folder when empty
+// Chat rules are checked before MIME type rules, the first match wins.
+// Without a match the download is saved to "downloads/folder".
+class DownloadRules
+{
+public:
+    struct Rule {
+        enum Kind { MimeType, Chat };
+        Kind kind = MimeType;
+        QString pattern;
+        bool ask = false;
+        QString folder;
+        // compiled from pattern by load()
+        QRegularExpression expression;
+    };
+
+    struct Decision {
+        bool ask = false;
+        QString folder;
+    };
+
+    void load(QSettings &settings);
+    // the "downloads/rules" array as stored, for editing
+    static QVector<Rule> read(QSettings &settings);
+    static void save(QSettings &settings, const QVector<Rule> &rules);
+    Decision decide(const QString &mimeType, const QString &chat) const;
+
+    // folder/fileName, or "name (2).ext" and so on if that exists on disk
+    // or is taken by a download that has not created its file yet
+    static QString uniqueFilePath(const QString &folder, const QString &fileName,
+                                  const QSet<QString> &reserved);
+
+private:
+    static QRegularExpression wildcard(const QString &pattern);
+    static bool matches(const Rule &rule, const QString &value);
+
+    QVector<Rule> m_rules;
+    QString m_defaultFolder;
+};
+
+#endif // DOWNLOADRULES_H
@@ -0,0 +1,257 @@
+#include "freedesktopnotifier.h"
+#include "avatarcache.h"
+
+#include <QApplication>
+#include <QDBusArgument>
+#include <QDBusConnectionInterface>
+#include <QDBusMetaType>
+#include <QDBusPendingCallWatcher>
+#include <QDBusPendingReply>
+#include <QDBusServiceWatcher>
+#include <QDBusMessage>
+#include <QDebug>
+
+namespace
+{
+    const char *service   = "org.freedesktop.Notifications";
+    const char *path      = "/org/freedesktop/Notifications";
+    const char *interface = "org.freedesktop.Notifications";
+    const int iconSize    = 64;
+    // ids of plain notify() calls are only dropped when the daemon closes them
+    const int maxOwnIds   = 256;
+
+    // the (iiibiiay) structure of the image-data hint
+    struct ImageData
+    {
+        QImage image;
+    };
+}
+Q_DECLARE_METATYPE(ImageData)
+
+QDBusArgument &operator<<(QDBusArgument &argument, const ImageData &data)
+{
+    const QImage image = data.image.convertToFormat(QImage::Format_RGBA8888);
+    argument.beginStructure();
+    argument << image.width() << image.height() << int(image.bytesPerLine())
+             << image.hasAlphaChannel() << 8 << 4
+             << QByteArray(reinterpret_cast<const char *>(image.constBits()), image.sizeInBytes());
+    argument.endStructure();
+    return argument;
+}
+
+const QDBusArgument &operator>>(const QDBusArgument &argument, ImageData &)
+{
+    // only ever sent
+    return argument;
+}
+
+FreedesktopNotifier::FreedesktopNotifier(const QDBusConnection &connection, QObject *parent)
+    : QObject(parent),
+      m_connection(connection)
+{
+    qDBusRegisterMetaType<ImageData>();
+
+    m_connection.connect(service, path, interface, "ActionInvoked",
+                         this, SLOT(onActionInvoked(uint,QString)));
+    m_connection.connect(service, path, interface, "NotificationClosed",
+                         this, SLOT(onNotificationClosed(uint,uint)));
+
+    // a daemon can come and go (e.g. a desktop shell restart)
+    QDBusServiceWatcher *watcher = new QDBusServiceWatcher(service, m_connection,
+            QDBusServiceWatcher::WatchForRegistration | QDBusServiceWatcher::WatchForUnregistration, this);
+    connect(watcher, &QDBusServiceWatcher::serviceRegistered, this, [=]() { m_available = true; });
+    connect(watcher, &QDBusServiceWatcher::serviceUnregistered, this, [=]() { m_available = false; });
+
+    if (!m_connection.isConnected() || !m_connection.interface())
+        return;
+    QDBusPendingCallWatcher *call = new QDBusPendingCallWatcher(
+                m_connection.interface()->asyncCall("NameHasOwner", QString(service)), this);
+    connect(call, &QDBusPendingCallWatcher::finished, this, [=](QDBusPendingCallWatcher *call) {
+        call->deleteLater();
+        QDBusPendingReply<bool> reply = *call;
+        if (!reply.isError())
+            m_available = reply.value();
+    });
+}
+
+FreedesktopNotifier::~FreedesktopNotifier()
+{
+    while (!m_entries.empty())
+        closeEntry(m_entries.begin()->first, true);
+}
+
+bool FreedesktopNotifier::isAvailable() const
+{
+    return m_available && m_connection.isConnected();
+}
+
+void FreedesktopNotifier::setAvatarCache(AvatarCache *avatars)
+{
+    m_avatars = avatars;
+}
+
+void FreedesktopNotifier::show(CoalescedNotification &item, int timeoutMs)
+{
+    Entry &entry = m_entries[item.title];
+    if (entry.notification) {
+        // its closed() would take the new notification of the chat with it
+        entry.notification->disconnect(this);
+        entry.notification->close();
+        entry.notification.release()->deleteLater();
+    }
+    const QImage icon = item.notification ? item.notification->icon() : QImage();
+    entry.notification = std::move(item.notification);
+    if (entry.notification) {
+        const QString chat = item.title;
+        connect(entry.notification.get(), &QWebEngineNotification::closed, this, [=]() {
+            closeEntry(chat, true);
+        });
+    }
+    if (m_avatars == nullptr || icon.isNull()) {
+        send(item.title, Message{item.title, item.message, icon, timeoutMs});
+        return;
+    }
+    const QString chat = item.title, message = item.message;
+    m_avatars->request(icon, iconSize, this, [=](const AvatarCache::Avatar &avatar) {
+        send(chat, Message{chat, message, avatar.image, timeoutMs});
+    });
+}
+
+void FreedesktopNotifier::notify(const QString &title, const QString &message, const QImage &icon,
+                                 int timeoutMs)
+{
+    send(QString(), Message{title, message, icon, timeoutMs});
+}
+
+void FreedesktopNotifier::send(const QString &chat, const Message &message)
+{
+    uint replacesId = 0;
+    if (!chat.isEmpty()) {
+        auto entry = m_entries.find(chat);
+        // closed meanwhile, e.g. while the avatar was scaled
+        if (entry == m_entries.end())
+            return;
+        // without the id a second Notify would add a notification, not replace it
+        if (entry->second.inFlight) {
+            entry->second.hasQueued = true;
+            entry->second.queued = message;
+            return;
+        }
+        entry->second.inFlight = true;
+        replacesId = entry->second.id;
+    }
+
+    const QImage &icon = message.icon;
+    QVariantMap hints;
+    hints.insert("desktop-entry", QApplication::desktopFileName());
+    if (!icon.isNull()) {
+        ImageData data{icon.height() <= iconSize && icon.width() <= iconSize
+                    ? icon : icon.scaled(iconSize, iconSize, Qt::KeepAspectRatio, Qt::SmoothTransformation)};
+        hints.insert("image-data", QVariant::fromValue(data));
+    }
+
+    QDBusMessage call = QDBusMessage::createMethodCall(service, path, interface, "Notify");
+    call << QApplication::applicationName()
+         << replacesId
+         << QString("whatsie")
+         << message.title
+         << message.message.toHtmlEscaped()
+         << QStringList({"default", tr("Open")})
+         << hints
+         << message.timeoutMs;
+
+    // asynchronous, a slow daemon must not block the GUI thread
+    QDBusPendingCallWatcher *watcher = new QDBusPendingCallWatcher(m_connection.asyncCall(call), this);
+    connect(watcher, &QDBusPendingCallWatcher::finished, this, [=](QDBusPendingCallWatcher *call) {
+        call->deleteLater();
+        QDBusPendingReply<uint> reply = *call;
+        if (reply.isError())
+            qWarning() << "Notify failed:" << reply.error().message();
+        if (chat.isEmpty()) {
+            if (!reply.isError())
+                rememberOwnId(reply.value());
+            return;
+        }
+
+        auto entry = m_entries.find(chat);
+        if (entry == m_entries.end()) {
+            // the chat was closed while we waited, don't leave its notification behind
+            if (!reply.isError())
+                m_connection.asyncCall(QDBusMessage::createMethodCall(service, path, interface,
+                                                                      "CloseNotification")
+                                       << reply.value());
+            return;
+        }
+        Entry &current = entry->second;
+        current.inFlight = false;
+        if (!reply.isError() && reply.value() != current.id) {
+            // the daemon did not replace it in place, the old id is gone
+            m_ownIds.remove(current.id);
+            m_chatById.remove(current.id);
+            current.id = reply.value();
+            m_chatById.insert(current.id, chat);
+            rememberOwnId(current.id);
+        }
+        if (current.hasQueued) {
+            current.hasQueued = false;
+            const Message queued = current.queued;
+            send(chat, queued);
+        }
+    });
+}
+
+void FreedesktopNotifier::rememberOwnId(uint id)
+{
+    m_ownIds.insert(id);
+    if (m_ownIds.size() <= maxOwnIds)
+        return;
+    // the daemon missed some NotificationClosed, keep the ids of the chats
+    for (auto it = m_ownIds.begin(); it != m_ownIds.end(); ) {
+        if (m_chatById.contains(*it) || *it == id)
+            ++it;
+        else
+            it = m_ownIds.erase(it);
+    }
+}
+
+void FreedesktopNotifier::closeEntry(const QString &chat, bool closeOnDaemon)
+{
+    auto entry = m_entries.find(chat);
+    if (entry == m_entries.end())
+        return;
+
+    if (closeOnDaemon && entry->second.id != 0) {
+        m_connection.asyncCall(QDBusMessage::createMethodCall(service, path, interface,
+                                                              "CloseNotification")
+                               << entry->second.id);
+    }
+    m_chatById.remove(entry->second.id);
+    m_ownIds.remove(entry->second.id);
+    if (entry->second.notification) {
+        entry->second.notification->disconnect(this);
+        entry->second.notification->close();
+        entry->second.notification.release()->deleteLater();
+    }
+    m_entries.erase(entry);
+}
+
+void FreedesktopNotifier::onActionInvoked(uint id, const QString &actionKey)
+{
+    if (actionKey != "default" || !m_ownIds.contains(id))
+        return;
+    const QString chat = m_chatById.value(id);
+    auto entry = m_entries.find(chat);
+    if (entry != m_entries.end() && entry->second.notification)
+        entry->second.notification->click();
+    emit clicked();
+}
+
+void FreedesktopNotifier::onNotificationClosed(uint id, uint reason)
+{
+    Q_UNUSED(reason)
+    if (!m_ownIds.remove(id))
+        return;
+    const QString chat = m_chatById.value(id);
+    if (!chat.isEmpty())
+        closeEntry(chat, false);
+}
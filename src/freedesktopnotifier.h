@@ -0,0 +1,85 @@
+#ifndef FREEDESKTOPNOTIFIER_H
+#define FREEDESKTOPNOTIFIER_H
+
+#include <QDBusConnection>
+#include <QHash>
+#include <QImage>
+#include <QObject>
+#include <QSet>
+
+#include <map>
+#include <memory>
+
+#include "notificationcoalescer.h"
+
+class AvatarCache;
+
+// Notification backend talking to org.freedesktop.Notifications directly,
+// no widgets involved. Every chat keeps one notification on screen that is
+// updated in place (replaces_id), clicking it ("default" action) clicks the
+// web notification and brings up the window. The icon is sent as image-data.
+// Notify is asynchronous, so while a chat waits for its id the next message
+// is held back, and only the latest one is sent once the id is known.
+//
+// Whether a daemon is registered is tracked with a QDBusServiceWatcher, so
+// isAvailable() never waits for the bus. The connection is a parameter only
+// to allow a bus other than the session bus.
+class FreedesktopNotifier : public QObject
+{
+    Q_OBJECT
+
+public:
+    explicit FreedesktopNotifier(const QDBusConnection &connection = QDBusConnection::sessionBus(),
+                                 QObject *parent = nullptr);
+    ~FreedesktopNotifier();
+
+    // a notification daemon is registered on the bus
+    bool isAvailable() const;
+
+    // scale icons through the shared cache instead of on every Notify
+    void setAvatarCache(AvatarCache *avatars);
+
+    void show(CoalescedNotification &item, int timeoutMs);
+    void notify(const QString &title, const QString &message, const QImage &icon, int timeoutMs);
+
+signals:
+    void clicked();
+
+private slots:
+    void onActionInvoked(uint id, const QString &actionKey);
+    void onNotificationClosed(uint id, uint reason);
+
+private:
+    struct Message {
+        QString title;
+        QString message;
+        QImage icon;
+        int timeoutMs;
+    };
+    struct Entry {
+        uint id = 0;
+        std::unique_ptr<QWebEngineNotification> notification;
+        // a Notify is waiting for its reply
+        bool inFlight = false;
+        // the newest message that came in meanwhile
+        bool hasQueued = false;
+        Message queued;
+    };
+
+    // replaces the chat's notification, if any; an empty chat always adds one
+    void send(const QString &chat, const Message &message);
+    void rememberOwnId(uint id);
+    void closeEntry(const QString &chat, bool closeOnDaemon);
+
+    QDBusConnection m_connection;
+    AvatarCache *m_avatars = nullptr;
+    // chat -> its notification; unique_ptr values, so not QHash
+    std::map<QString, Entry> m_entries;
+    QHash<uint, QString> m_chatById;
+    // follows the daemon's name owner, starts out false until the bus answers
+    bool m_available = false;
+    // ids of our notifications on screen, the daemon signals are broadcast
+    QSet<uint> m_ownIds;
+};
+
+#endif // FREEDESKTOPNOTIFIER_H
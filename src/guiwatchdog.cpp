@@ -0,0 +1,220 @@
+#include "guiwatchdog.h"
+
+#include "utils.h"
+
+#include <QCoreApplication>
+#include <QDateTime>
+#include <QDebug>
+#include <QEvent>
+#include <QFile>
+#include <QSettings>
+#include <QTextStream>
+
+#if defined(Q_OS_LINUX) && defined(__GLIBC__)
+#define WATCHDOG_BACKTRACE
+#include <execinfo.h>
+#include <pthread.h>
+#include <signal.h>
+#include <stdlib.h>
+#include <unistd.h>
+#endif
+
+namespace
+{
+    const QEvent::Type HeartbeatEvent = QEvent::Type(QEvent::User + 718);
+    const int beatIntervalMs = 100;
+
+#ifdef WATCHDOG_BACKTRACE
+    const int maxFrames = 64;
+    void *frames[maxFrames];
+    std::atomic<int> frameCount{0};
+    std::atomic<bool> framesReady{false};
+    pthread_t mainThread;
+
+    void sampleHandler(int)
+    {
+        frameCount = backtrace(frames, maxFrames);
+        framesReady = true;
+    }
+
+    int sampleSignal()
+    {
+        return SIGRTMIN + 3;
+    }
+#endif
+}
+
+// Lives in the GUI thread, answers the heartbeat.
+class HeartbeatReceiver : public QObject
+{
+public:
+    explicit HeartbeatReceiver(GuiWatchdog *watchdog) : m_watchdog(watchdog) {}
+
+    bool event(QEvent *event) override
+    {
+        if (event->type() == HeartbeatEvent) {
+            m_watchdog->m_lastBeat = m_watchdog->m_clock.elapsed();
+            m_watchdog->m_beatPending = false;
+            return true;
+        }
+        return QObject::event(event);
+    }
+
+private:
+    GuiWatchdog *m_watchdog;
+};
+
+GuiWatchdog::GuiWatchdog(QObject *parent)
+    : QThread(parent)
+{
+    QSettings settings;
+    m_thresholdMs = qMax(100, settings.value("watchdog/thresholdMs", 500).toInt());
+    m_logPath = utils::returnPath("logs") + "stalls.log";
+    m_receiver = new HeartbeatReceiver(this);
+    m_clock.start();
+    setObjectName("GuiWatchdog");
+
+#ifdef WATCHDOG_BACKTRACE
+    mainThread = pthread_self();
+    // backtrace() loads libgcc on first use, which is not safe inside a handler
+    backtrace(frames, 1);
+    struct sigaction action = {};
+    action.sa_handler = sampleHandler;
+    action.sa_flags = SA_RESTART;
+    sigemptyset(&action.sa_mask);
+    sigaction(sampleSignal(), &action, nullptr);
+#endif
+}
+
+GuiWatchdog::~GuiWatchdog()
+{
+    stopWatching();
+    delete m_receiver;
+}
+
+bool GuiWatchdog::isEnabled()
+{
+    return QSettings().value("watchdog/enabled", false).toBool();
+}
+
+void GuiWatchdog::startWatching()
+{
+    if (isRunning())
+        return;
+    m_stop = false;
+    m_lastBeat = m_clock.elapsed();
+    m_beatPending = false;
+    QCoreApplication::instance()->installEventFilter(this);
+    start(QThread::LowPriority);
+}
+
+void GuiWatchdog::stopWatching()
+{
+    if (!isRunning())
+        return;
+    QCoreApplication::instance()->removeEventFilter(this);
+    m_mutex.lock();
+    m_stop = true;
+    m_wake.wakeAll();
+    m_mutex.unlock();
+    wait();
+}
+
+// Remembers what the GUI thread is about to dispatch; cheap, no strings.
+bool GuiWatchdog::eventFilter(QObject *watched, QEvent *event)
+{
+    if (event->type() != HeartbeatEvent) {
+        m_lastReceiverClass = watched->metaObject();
+        m_lastEventType = event->type();
+    }
+    return false;
+}
+
+void GuiWatchdog::heartbeat()
+{
+    if (!m_beatPending) {
+        m_beatPending = true;
+        QCoreApplication::postEvent(m_receiver, new QEvent(HeartbeatEvent), Qt::HighEventPriority);
+    }
+}
+
+void GuiWatchdog::run()
+{
+    bool inStall = false;
+    qint64 stallStart = 0;
+    QString dispatch;
+    QStringList trace;
+
+    QMutexLocker locker(&m_mutex);
+    while (!m_stop) {
+        m_wake.wait(&m_mutex, beatIntervalMs);
+        if (m_stop)
+            break;
+
+        const qint64 now = m_clock.elapsed();
+        const qint64 lastBeat = m_lastBeat;
+
+        if (!m_beatPending) {
+            if (inStall) {
+                inStall = false;
+                reportStall(lastBeat - stallStart, dispatch, trace);
+            }
+            heartbeat();
+            continue;
+        }
+
+        if (!inStall && now - lastBeat > m_thresholdMs) {
+            inStall = true;
+            stallStart = lastBeat;
+            const QMetaObject *receiverClass = m_lastReceiverClass;
+            const int eventType = m_lastEventType;
+            dispatch = QString("%1 (event %2%3)")
+                    .arg(receiverClass ? receiverClass->className() : "?")
+                    .arg(eventType)
+                    .arg(eventType == QEvent::Timer ? ", timer"
+                         : eventType == QEvent::MetaCall ? ", queued slot" : "");
+            trace = captureMainThreadBacktrace();
+        }
+    }
+}
+
+QStringList GuiWatchdog::captureMainThreadBacktrace()
+{
+    QStringList lines;
+#ifdef WATCHDOG_BACKTRACE
+    framesReady = false;
+    if (pthread_kill(mainThread, sampleSignal()) != 0)
+        return lines;
+    for (int i = 0; i < 50 && !framesReady; ++i)
+        usleep(1000);
+    if (!framesReady)
+        return lines;
+
+    const int count = frameCount;
+    char **symbols = backtrace_symbols(frames, count);
+    if (symbols == nullptr)
+        return lines;
+    // skip the signal handler and the signal trampoline
+    for (int i = 2; i < count; ++i)
+        lines.append(QString::fromLocal8Bit(symbols[i]));
+    free(symbols);
+#endif
+    return lines;
+}
+
+void GuiWatchdog::reportStall(qint64 durationMs, const QString &dispatch, const QStringList &backtrace)
+{
+    qWarning() << "GUI thread stalled for" << durationMs << "ms while dispatching" << dispatch;
+
+    QFile file(m_logPath);
+    // keep the log small, start over once it grows past 1 MiB
+    if (file.size() > 1024 * 1024)
+        file.remove();
+    if (!file.open(QIODevice::Append | QIODevice::Text))
+        return;
+    QTextStream out(&file);
+    out << QDateTime::currentDateTime().toString(Qt::ISODate)
+        << " stall " << durationMs << " ms, dispatching " << dispatch << "\n";
+    for (const QString &frame : backtrace)
+        out << "    " << frame << "\n";
+}
@@ -0,0 +1,66 @@
+#ifndef GUIWATCHDOG_H
+#define GUIWATCHDOG_H
+
+#include <QElapsedTimer>
+#include <QMutex>
+#include <QThread>
+#include <QWaitCondition>
+
+#include <atomic>
+
+// Watches the GUI thread from a helper thread. A heartbeat event is posted
+// to the main event loop; when it is not delivered within the threshold the
+// GUI thread is stalled. On Linux/glibc a backtrace of the main thread is
+// then captured (signal + backtrace(3), link with -rdynamic for symbols).
+//
+// Each stall is logged with its duration, the class of the object and the
+// event being dispatched when it began (a QTimer, a queued slot call, ...)
+// and the backtrace, to qWarning and to <data>/logs/stalls.log.
+//
+// The heartbeat wakes the GUI thread ten times a second, so the watchdog is
+// opt-in and main() stops it while the window is hidden to the tray.
+//
+// Settings: watchdog/enabled (false), watchdog/thresholdMs (500).
+class GuiWatchdog : public QThread
+{
+    Q_OBJECT
+
+public:
+    explicit GuiWatchdog(QObject *parent = nullptr);
+    ~GuiWatchdog();
+
+    static bool isEnabled();
+
+    // Starts the heartbeat, call once the event loop is about to run.
+    void startWatching();
+    void stopWatching();
+
+protected:
+    void run() override;
+    bool eventFilter(QObject *watched, QEvent *event) override;
+
+private:
+    friend class HeartbeatReceiver;
+
+    void heartbeat();
+    void reportStall(qint64 durationMs, const QString &dispatch, const QStringList &backtrace);
+    QStringList captureMainThreadBacktrace();
+
+    QObject *m_receiver = nullptr;
+    QElapsedTimer m_clock;
+    int m_thresholdMs;
+    QString m_logPath;
+
+    QMutex m_mutex;
+    QWaitCondition m_wake;
+    bool m_stop = false;
+
+    std::atomic<qint64> m_lastBeat{0};
+    std::atomic<bool> m_beatPending{false};
+
+    // written by the GUI thread for every event, read only on a stall
+    std::atomic<const QMetaObject *> m_lastReceiverClass{nullptr};
+    std::atomic<int> m_lastEventType{0};
+};
+
+#endif // GUIWATCHDOG_H
@@ -0,0 +1,70 @@
+#ifndef LAZYWIDGET_H
+#define LAZYWIDGET_H
+
+#include <QPointer>
+#include <QVector>
+#include <QWidget>
+
+#include <functional>
+
+// Holds a widget that is only constructed the first time it is needed.
+// Initializers registered with onCreated() (signal wiring, initial state)
+// run right after construction, and run again if the widget was destroyed
+// (e.g. WA_DeleteOnClose) and later recreated.
+template <typename T>
+class LazyWidget
+{
+public:
+    using Factory     = std::function<T*()>;
+    using Initializer = std::function<void(T*)>;
+
+    LazyWidget() = default;
+    explicit LazyWidget(Factory factory) : m_factory(std::move(factory)) {}
+
+    void setFactory(Factory factory)
+    {
+        m_factory = std::move(factory);
+    }
+
+    void onCreated(Initializer initializer)
+    {
+        m_initializers.append(initializer);
+        if (m_widget)
+            initializer(m_widget.data());
+    }
+
+    // Constructs the widget on first use.
+    T *get()
+    {
+        if (m_widget.isNull() && m_factory) {
+            m_widget = m_factory();
+            for (const Initializer &initializer : qAsConst(m_initializers))
+                initializer(m_widget.data());
+        }
+        return m_widget.data();
+    }
+
+    T *operator->() { return get(); }
+
+    bool isCreated() const { return !m_widget.isNull(); }
+
+    // Returns the widget without constructing it, may be nullptr.
+    T *peek() const { return m_widget.data(); }
+
+    // Runs fn only if the widget already exists.
+    template <typename Fn>
+    void ifCreated(Fn fn) const
+    {
+        if (m_widget)
+            fn(m_widget.data());
+    }
+
+private:
+    Factory m_factory;
+    QVector<Initializer> m_initializers;
+    QPointer<T> m_widget;
+
+    Q_DISABLE_COPY(LazyWidget)
+};
+
+#endif // LAZYWIDGET_H
@@ -5,16 +5,35 @@
 #include <QWebEngineSettings>
 #include <QSettings>
 #include <QDebug>
+#include <QProcess>
 
 #include "mainwindow.h"
 
 #include "rungaurd.h"
 #include "common.h"
+#include "chromiumflags.h"
+#include "guiwatchdog.h"
+#include "startuptracer.h"
+#include "terminalserver.h"
 
 
 int main(int argc, char *argv[])
 {
+    StartupTracer::init(argc, argv);
+    StartupTracer::begin("main");
+
+    // needed by QSettings before QApplication exists
+    QApplication::setApplicationName("WhatSie");
+    QApplication::setOrganizationName("org.keshavnrj.ubuntu");
+    QApplication::setApplicationVersion(VERSIONSTR);
+
+    // chromium flags are read when QApplication initializes the web engine
+    TerminalServerMode::init(argc, argv);
+    ChromiumFlags::apply(TerminalServerMode::chromiumFlags());
+
+    StartupTracer::begin("QApplication");
     QApplication app(argc, argv);
+    StartupTracer::end("QApplication");
     app.setWindowIcon(QIcon(":/icons/app/icon-256.png"));
 
     QApplication::setAttribute(Qt::AA_EnableHighDpiScaling);
@@ -26,16 +45,18 @@ int main(int argc, char *argv[])
         QCoreApplication::setAttribute(Qt::AA_EnableHighDpiScaling);
     }
 
-    QApplication::setApplicationName("WhatSie");
-    QApplication::setOrganizationName("org.keshavnrj.ubuntu");
-    QApplication::setApplicationVersion(VERSIONSTR);
-
     QString appname = QApplication::applicationName();
 
     //allow multiple instances in debug builds
     #ifndef QT_DEBUG
+        StartupTracer::begin("RunGuard::tryToRun");
         RunGuard guard("org.keshavnrj.ubuntu."+appname);
-        if ( !guard.tryToRun() ){
+        const bool canRun = guard.tryToRun();
+        StartupTracer::end("RunGuard::tryToRun");
+        if ( !canRun ){
+            // hand our arguments (whatsapp:// links, --show, --new-chat) to the running instance
+            if ( guard.sendMessage(app.arguments().mid(1)) )
+                return 0;
             QMessageBox::critical(0, appname,"An instance of "+appname+" is already running.");
             return 0;
         }
@@ -46,17 +67,50 @@ int main(int argc, char *argv[])
     QWebEngineSettings::defaultSettings()->setAttribute(QWebEngineSettings::DnsPrefetchEnabled, true);
     QWebEngineSettings::defaultSettings()->setAttribute(QWebEngineSettings::FullScreenSupportEnabled, true);
 
+    QObject::connect(&app, &QApplication::aboutToQuit, &StartupTracer::finish);
+
     MainWindow window;
 
+    #ifndef QT_DEBUG
+        QObject::connect(&guard, &RunGuard::messageReceived,
+                         &window, &MainWindow::handleArguments, Qt::QueuedConnection);
+    #endif
+
     QStringList argsList = app.arguments();
     qWarning()<<"Launching with argument"<<argsList;
-    foreach (QString argStr, argsList) {
-        if(argStr.contains("whatsapp://")){
-            qWarning()<<"Link passed as argument"<<argStr;
-            window.loadAppWithArgument(argStr);
-        }
-    }
+    window.handleArguments(argsList.mid(1));
     window.show();
 
-    return app.exec();
+    // started from the event loop, startup itself is covered by --trace-startup
+    // not even constructed unless enabled, it installs a signal handler
+    QScopedPointer<GuiWatchdog> watchdog;
+    if(GuiWatchdog::isEnabled()){
+        watchdog.reset(new GuiWatchdog);
+        GuiWatchdog *guiWatchdog = watchdog.data();
+        QTimer::singleShot(0, guiWatchdog, &GuiWatchdog::startWatching);
+        QObject::connect(&app, &QApplication::aboutToQuit, guiWatchdog, &GuiWatchdog::stopWatching);
+        // the heartbeat wakes the GUI thread, nobody sees a stall in the tray
+        QObject::connect(&window, &MainWindow::trayHiddenChanged, guiWatchdog, [=](bool hidden){
+            if(hidden)
+                guiWatchdog->stopWatching();
+            else if(!QApplication::closingDown())
+                guiWatchdog->startWatching();
+        });
+    }
+
+    StartupTracer::end("main");
+
+    int result = app.exec();
+
+    // MainWindow::restartApp(), e.g. after the engine preset changed
+    if(app.property("restartRequested").toBool()){
+        #ifndef QT_DEBUG
+            guard.release();
+        #endif
+        ChromiumFlags::restoreEnvironment();
+        QProcess::startDetached(QApplication::applicationFilePath(),
+                                QApplication::arguments().mid(1));
+    }
+
+    return result;
 }
@@ -6,14 +6,19 @@
 #include <QUrlQuery>
 #include <QWebEngineNotification>
 
+#include "startuptracer.h"
+#include "terminalserver.h"
+
 extern QString defaultUserAgentStr;
 
 MainWindow::MainWindow(QWidget *parent)
     : QMainWindow(parent),
-      notificationsTitleRegExp("^\\([1-9]\\d*\\).*"),
       trayIconRead(":/icons/app/whatsapp.svg"),
-      trayIconUnread(":/icons/app/whatsapp-message.svg")
+      trayIconUnread(":/icons/app/whatsapp-message.svg"),
+      trayBadge(trayIconRead, trayIconUnread)
 {
+    StartupTracer::Scope traceScope("MainWindow::MainWindow");
+
     this->setObjectName("MainWindow");
 
     qApp->setQuitOnLastWindowClosed(false);
@@ -34,6 +39,7 @@ MainWindow::MainWindow(QWidget *parent)
     createTrayIcon();
     createWebEngine();
 
+    init_lockWidget();
     if(settings.value("lockscreen",false).toBool())
     {
         init_lock();
@@ -42,7 +48,7 @@ MainWindow::MainWindow(QWidget *parent)
     timer->setInterval(1000);
     connect(timer,&QTimer::timeout,[=](){
         if(settings.value("asdfg").isValid()){
-            if(lockWidget && lockWidget->isLocked==false){
+            if(lockWidget.isCreated() && lockWidget->isLocked==false){
                 timer->stop();
                 //init_accountWidget();
             }
@@ -51,27 +57,34 @@ MainWindow::MainWindow(QWidget *parent)
     timer->start();
 
     init_settingWidget();
-
-    // quit application if the download manager window is the only remaining window
-    m_downloadManagerWidget.setAttribute(Qt::WA_QuitOnClose, false);
+    init_downloadManagerWidget();
+    init_resourceMonitor();
 
     updateWindowTheme();
 
-    RateApp *rateApp = new RateApp(this, "snap://whatsie", 5, 5, 1000 * 30);
-    rateApp->setWindowTitle(QApplication::applicationName()+" | "+tr("Rate Application"));
-    rateApp->setVisible(false);
-    rateApp->setWindowFlags(Qt::Dialog);
-    rateApp->setAttribute(Qt::WA_DeleteOnClose,true);
-    QPoint centerPos = this->geometry().center()-rateApp->geometry().center();
-    connect(rateApp,&RateApp::showRateDialog,[=]()
-    {
-        if(this->windowState() != Qt::WindowMinimized && this->isVisible() && isActiveWindow()){
-            rateApp->move(centerPos);
-            rateApp->show();
-        }else{
-            rateApp->delayShowEvent();
+    init_rateApp();
+}
+
+// arguments of this launch, or forwarded by a later launch through RunGuard
+void MainWindow::handleArguments(const QStringList &arguments)
+{
+    foreach (QString argStr, arguments) {
+        if(argStr.contains("whatsapp://")){
+            qWarning()<<"Link passed as argument"<<argStr;
+            loadAppWithArgument(argStr);
+        }else if(argStr == "--new-chat"){
+            QTimer::singleShot(0, this, &MainWindow::newChat);
         }
-    });
+    }
+
+    // any launch, with or without arguments, brings the window up
+    if(this->isMinimized()){
+        showNormal();
+    }else{
+        show();
+    }
+    raise();
+    activateWindow();
 }
 
 void MainWindow::loadAppWithArgument(const QString &arg)
@@ -116,21 +129,35 @@ void MainWindow::updatePageTheme()
     if(windowTheme == "dark"){
         webPageTheme = "web dark";
     }
-    if(webEngine && webEngine->page()){
-        webEngine->page()->runJavaScript(
-            "document.querySelector('body').className='"+webPageTheme+"';",
-            [](const QVariant &result){
-                qDebug() << "Value is: " << result.toString() << endl;
-            }
-        );
-    }
+    // delivered once the page side of the bridge is up
+    pageBridge->post("setTheme", webPageTheme);
 }
 
 void MainWindow::resizeEvent(QResizeEvent *event)
 {
-    if(lockWidget != nullptr){
-        lockWidget->resize(event->size());
+    lockWidget.ifCreated([event](Lock *lock){
+        lock->resize(event->size());
+    });
+}
+
+void MainWindow::hideEvent(QHideEvent *event)
+{
+    QMainWindow::hideEvent(event);
+    // minimizing keeps the window "visible", only hiding to tray counts
+    if(this->isVisible() == false){
+        if(lifecycleManager != nullptr)
+            lifecycleManager->windowHidden();
+        emit trayHiddenChanged(true);
+    }
+}
+
+void MainWindow::showEvent(QShowEvent *event)
+{
+    QMainWindow::showEvent(event);
+    if(lifecycleManager != nullptr){
+        lifecycleManager->windowShown();
     }
+    emit trayHiddenChanged(false);
 }
 
 void MainWindow::updateWindowTheme()
@@ -176,13 +203,15 @@ void MainWindow::updateWindowTheme()
         w->setPalette(qApp->palette());
     }
 
-    setNotificationPresenter(webEngine->page()->profile());
-
-    if(lockWidget!=nullptr)
-    {
-        lockWidget->setStyleSheet("QWidget#login{background-color:palette(window)};"
-                                  "QWidget#signup{background-color:palette(window)};");
-        lockWidget->applyThemeQuirks();
+    lockWidget.ifCreated([](Lock *lock){
+        lock->setStyleSheet("QWidget#login{background-color:palette(window)};"
+                            "QWidget#signup{background-color:palette(window)};");
+        lock->applyThemeQuirks();
+    });
+    // the badge outline follows the theme
+    if(shownUnreadCount > 0){
+        shownUnreadCount = -1;
+        updateTrayBadge();
     }
     this->update();
 }
@@ -195,13 +224,21 @@ void MainWindow::handleCookieAdded(const QNetworkCookie &cookie)
 
 void MainWindow::init_settingWidget()
 {
-    if(settingsWidget == nullptr)
+    StartupTracer::Scope traceScope("init_settingWidget");
+
+    // SettingsWidget is built the first time it is shown, the wiring below
+    // is replayed on every construction
+    settingsWidget.setFactory([=]()
     {
-        settingsWidget = new SettingsWidget(this,webEngine->page()->profile()->cachePath()
+        SettingsWidget *settingsWidget = new SettingsWidget(this,webEngine->page()->profile()->cachePath()
                                             ,webEngine->page()->profile()->persistentStoragePath());
         settingsWidget->setWindowTitle(QApplication::applicationName()+" | Settings");
         settingsWidget->setWindowFlags(Qt::Dialog);
+        return settingsWidget;
+    });
 
+    settingsWidget.onCreated([=](SettingsWidget *settingsWidget)
+    {
         connect(settingsWidget,SIGNAL(init_lock()),this,SLOT(init_lock()));
         connect(settingsWidget,SIGNAL(updateWindowTheme()),this,SLOT(updateWindowTheme()));
         connect(settingsWidget,SIGNAL(updatePageTheme()),this,SLOT(updatePageTheme()));
@@ -251,27 +288,93 @@ void MainWindow::init_settingWidget()
             webEngine->page()->setZoomFactor(currentFactor);
         });
 
-        connect(settingsWidget,&SettingsWidget::notificationPopupTimeOutChanged,[=](){
-           setNotificationPresenter(this->webEngine->page()->profile());
-        });
+        connect(settingsWidget,&SettingsWidget::notificationSettingsChanged,
+                this,&MainWindow::reloadNotificationSettings);
 
         connect(settingsWidget,&SettingsWidget::notify,[=](QString message)
         {
            notify("",message);
         });
 
+        connect(settingsWidget,&SettingsWidget::lifecycleSettingsChanged,
+                lifecycleManager,&PageLifecycleManager::reloadSettings);
+
+        connect(settingsWidget,&SettingsWidget::restartRequested,
+                this,&MainWindow::restartApp);
+
+        connect(settingsWidget,&SettingsWidget::showResourceMonitor,
+                this,&MainWindow::showResourceMonitor);
+
         settingsWidget->appLockSetChecked(settings.value("lockscreen",false).toBool());
 
         //spell checker
         settingsWidget->loadDictionaries(m_dictionaries);
 
         settingsWidget->resize(settingsWidget->sizeHint().width(),settingsWidget->minimumSizeHint().height());
-    }
+        settingsWidget->setPalette(qApp->palette());
+    });
+}
+
+void MainWindow::init_downloadManagerWidget()
+{
+    m_downloadManagerWidget.setFactory([=]()
+    {
+        DownloadManagerWidget *downloadManagerWidget = new DownloadManagerWidget(this);
+        downloadManagerWidget->setWindowFlags(Qt::Window);
+        // quit application if the download manager window is the only remaining window
+        downloadManagerWidget->setAttribute(Qt::WA_QuitOnClose, false);
+        downloadManagerWidget->setPalette(qApp->palette());
+        downloadManagerWidget->setPage(webEngine->page());
+        return downloadManagerWidget;
+    });
+}
+
+void MainWindow::init_resourceMonitor()
+{
+    resourceMonitor.setFactory([=]()
+    {
+        ResourceMonitorWidget *monitor = new ResourceMonitorWidget(this);
+        monitor->setWindowFlags(Qt::Window);
+        monitor->setAttribute(Qt::WA_QuitOnClose, false);
+        return monitor;
+    });
+    resourceMonitor.onCreated([=](ResourceMonitorWidget *monitor){
+        monitor->setExtraInfo(diagnosticsText());
+    });
+}
+
+void MainWindow::init_rateApp()
+{
+    // bookkeeping only, the dialog itself is built when it is due
+    if(RateApp::registerLaunch(5, 5) == false)
+        return;
+
+    rateApp.setFactory([=]()
+    {
+        RateApp *rateApp = new RateApp(this, "snap://whatsie", 5, 5, 1000 * 30);
+        rateApp->setWindowTitle(QApplication::applicationName()+" | "+tr("Rate Application"));
+        rateApp->setVisible(false);
+        rateApp->setWindowFlags(Qt::Dialog);
+        rateApp->setAttribute(Qt::WA_DeleteOnClose,true);
+        return rateApp;
+    });
+    rateApp.onCreated([=](RateApp *rateApp)
+    {
+        connect(rateApp,&RateApp::showRateDialog,[=]()
+        {
+            if(this->windowState() != Qt::WindowMinimized && this->isVisible() && isActiveWindow()){
+                rateApp->move(this->geometry().center()-rateApp->rect().center());
+                rateApp->show();
+            }else{
+                rateApp->delayShowEvent();
+            }
+        });
+    });
 }
 
 void MainWindow::lockApp()
 {
-    if(lockWidget != nullptr && lockWidget->isLocked)
+    if(lockWidget.isCreated() && lockWidget->isLocked)
         return;
 
 //    if(settings.value("asdfg").isValid() && settings.value("lockscreen").toBool()==false){
@@ -301,7 +404,7 @@ void MainWindow::lockApp()
 
 void MainWindow::showSettings()
 {
-    if(lockWidget && lockWidget->isLocked){
+    if(lockWidget.isCreated() && lockWidget->isLocked){
         QMessageBox::critical(this,QApplication::applicationName()+"| Error",
                               "UnLock Application to access Settings.");
         this->show();
@@ -315,12 +418,38 @@ void MainWindow::showSettings()
     }
     if(!settingsWidget->isVisible())
     {
+     settingsWidget->setLifecycleStats(lifecycleManager->statsText());
      this->updateSettingsUserAgentWidget();
      settingsWidget->refresh();
      settingsWidget->showNormal();
     }
 }
 
+// page side details for the resource monitor
+QString MainWindow::diagnosticsText() const
+{
+    QStringList lines;
+    lines.append(healthMonitor->statsText());
+    if(crashRecovery != nullptr)
+        lines.append(crashRecovery->statsText());
+    if(recoveryLadder != nullptr)
+        lines.append(tr("Recovery ladder:")+"\n"+recoveryLadder->statsText());
+    lines.append(notificationCoalescer->statsText());
+    lines.append(avatarCache->statsText());
+    lines.append(DownloadResumer::statsText());
+    QString bridgeStats = pageBridge->statsText();
+    if(bridgeStats.isEmpty() == false)
+        lines.append(tr("Page bridge:")+"\n"+bridgeStats);
+    return lines.join("\n");
+}
+
+void MainWindow::showResourceMonitor()
+{
+    resourceMonitor->showNormal();
+    resourceMonitor->raise();
+    resourceMonitor->activateWindow();
+}
+
 void MainWindow::updateSettingsUserAgentWidget()
 {
     settingsWidget->updateDefaultUAButton(this->webEngine->page()->profile()->httpUserAgent());
@@ -353,7 +482,9 @@ void MainWindow::closeEvent(QCloseEvent *event)
     settings.setValue("windowState", saveState());
     getPageTheme();
     QTimer::singleShot(500,[=](){
-        settingsWidget->refresh();
+        settingsWidget.ifCreated([](SettingsWidget *settingsWidget){
+            settingsWidget->refresh();
+        });
     });
 
     if(QSystemTrayIcon::isSystemTrayAvailable() && settings.value("closeButtonActionCombo",0).toInt() == 0){
@@ -392,24 +523,20 @@ void MainWindow::notify(QString title, QString message)
             }
         });
     }
+#ifdef Q_OS_LINUX
+    else if(notificationBackend == 2 && freedesktopNotifier && freedesktopNotifier->isAvailable())
+    {
+        freedesktopNotifier->notify(title,message,QImage(":/icons/app/icon-64.png"),notificationTimeOut);
+    }
+#endif
     else{
-        auto popup = new NotificationPopup(webEngine);
-        connect(popup,&NotificationPopup::notification_clicked,[=](){
-            if(windowState() == Qt::WindowMinimized || windowState() != Qt::WindowActive){
-                activateWindow();
-                raise();
-                showNormal();
-            }
-        });
-        popup->style()->polish(qApp);
-        popup->setMinimumWidth(300);
-        popup->adjustSize();
-        popup->present(title,message,QPixmap(":/icons/app/icon-64.png"));
+        notificationManager->notify(title,message,QPixmap(":/icons/app/icon-64.png"));
     }
 }
 
 void MainWindow::createActions()
 {
+    StartupTracer::Scope traceScope("createActions");
 
     openUrlAction = new QAction("New Chat",this);
     this->addAction(openUrlAction);
@@ -449,6 +576,9 @@ void MainWindow::createActions()
     connect(settingsAction, &QAction::triggered, this, &MainWindow::showSettings);
 
 
+    resourceMonitorAction = new QAction(tr("Resource &monitor"), this);
+    connect(resourceMonitorAction, &QAction::triggered, this, &MainWindow::showResourceMonitor);
+
     aboutAction = new QAction(tr("&About"), this);
     connect(aboutAction, &QAction::triggered, this, &MainWindow::showAbout);
 
@@ -469,8 +599,16 @@ void MainWindow::quitApp()
     });
 }
 
+// main() starts a new instance once the event loop has quit
+void MainWindow::restartApp()
+{
+    qApp->setProperty("restartRequested",true);
+    quitApp();
+}
+
 void MainWindow::createTrayIcon()
 {
+    StartupTracer::Scope traceScope("createTrayIcon");
     trayIconMenu = new QMenu(this);
     trayIconMenu->setObjectName("trayIconMenu");
     trayIconMenu->addAction(minimizeAction);
@@ -481,6 +619,7 @@ void MainWindow::createTrayIcon()
     trayIconMenu->addSeparator();
     trayIconMenu->addAction(openUrlAction);
     trayIconMenu->addAction(settingsAction);
+    trayIconMenu->addAction(resourceMonitorAction);
     trayIconMenu->addAction(aboutAction);
     trayIconMenu->addSeparator();
     trayIconMenu->addAction(quitAction);
@@ -507,43 +646,57 @@ void MainWindow::createTrayIcon()
 }
 
 
-void MainWindow::init_lock()
+void MainWindow::init_lockWidget()
 {
-    if(lockWidget==nullptr){
-        lockWidget = new Lock(this);
-        lockWidget->setObjectName("lockWidget");
-    }
-        lockWidget->setWindowFlags(Qt::Widget);
-        lockWidget->setStyleSheet("QWidget#login{background-color:palette(window)};"
-                                  "QWidget#signup{background-color:palette(window)}");
-        lockWidget->setSizePolicy(QSizePolicy::Expanding,QSizePolicy::Expanding);
-        lockWidget->setGeometry(this->rect());
-
-        connect(lockWidget,&Lock::passwordNotSet,[=]()
+    lockWidget.setFactory([=]()
+    {
+        Lock *lock = new Lock(this);
+        lock->setObjectName("lockWidget");
+        return lock;
+    });
+    lockWidget.onCreated([=](Lock *lock)
+    {
+        connect(lock,&Lock::passwordNotSet,[=]()
         {
             settings.setValue("lockscreen",false);
-            settingsWidget->appLockSetChecked(false);
+            settingsWidget.ifCreated([](SettingsWidget *settingsWidget){
+                settingsWidget->appLockSetChecked(false);
+            });
         });
 
-        connect(lockWidget,&Lock::unLocked,[=]()
+        connect(lock,&Lock::unLocked,[=]()
         {
             //unlock event
         });
 
-        connect(lockWidget,&Lock::passwordSet,[=](){
+        connect(lock,&Lock::passwordSet,[=](){
             //enable disable lock screen
-            if(settings.value("asdfg").isValid()){
-                settingsWidget->setCurrentPasswordText("Current Password: <i>"
-                        +QByteArray::fromBase64(settings.value("asdfg").toString().toUtf8())+"</i>");
-            }else{
-               settingsWidget->setCurrentPasswordText("Current Password: <i>Require setup</i>");
-            }
-            settingsWidget->appLockSetChecked(settings.value("lockscreen",false).toBool());
+            settingsWidget.ifCreated([=](SettingsWidget *settingsWidget){
+                if(settings.value("asdfg").isValid()){
+                    settingsWidget->setCurrentPasswordText("Current Password: <i>"
+                            +QByteArray::fromBase64(settings.value("asdfg").toString().toUtf8())+"</i>");
+                }else{
+                   settingsWidget->setCurrentPasswordText("Current Password: <i>Require setup</i>");
+                }
+                settingsWidget->appLockSetChecked(settings.value("lockscreen",false).toBool());
+            });
         });
-        lockWidget->applyThemeQuirks();
-        lockWidget->show();
+    });
+}
+
+void MainWindow::init_lock()
+{
+        Lock *lock = lockWidget.get();
+        lock->setWindowFlags(Qt::Widget);
+        lock->setStyleSheet("QWidget#login{background-color:palette(window)};"
+                                  "QWidget#signup{background-color:palette(window)}");
+        lock->setSizePolicy(QSizePolicy::Expanding,QSizePolicy::Expanding);
+        lock->setGeometry(this->rect());
+
+        lock->applyThemeQuirks();
+        lock->show();
         if(settings.value("asdfg").isValid() && settings.value("lockscreen").toBool()==true){
-            lockWidget->lock_app();
+            lock->lock_app();
         }
         updateWindowTheme();
 }
@@ -560,7 +713,7 @@ void MainWindow::check_window_state()
             ((QMenu*)(tray_icon_menu))->actions().at(0)->setDisabled(true);
             ((QMenu*)(tray_icon_menu))->actions().at(1)->setDisabled(false);
         }
-        if(lockWidget && lockWidget->isLocked){
+        if(lockWidget.isCreated() && lockWidget->isLocked){
             ((QMenu*)(tray_icon_menu))->actions().at(4)->setDisabled(true);
         }else{
             ((QMenu*)(tray_icon_menu))->actions().at(4)->setDisabled(false);
@@ -570,10 +723,15 @@ void MainWindow::check_window_state()
 
 void MainWindow::init_globalWebProfile()
 {
+    StartupTracer::Scope traceScope("init_globalWebProfile");
 
     QWebEngineProfile *profile = QWebEngineProfile::defaultProfile();
     profile->setHttpUserAgent(settings.value("useragent",defaultUserAgentStr).toString());
 
+    if(TerminalServerMode::isEnabled()){
+        profile->setHttpCacheMaximumSize(TerminalServerMode::httpCacheMaximumSize());
+    }
+
     QStringList dict_names;
     dict_names.append(settings.value("sc_dict","en-US").toString());
 
@@ -600,6 +758,7 @@ void MainWindow::init_globalWebProfile()
 
 void MainWindow::createWebEngine()
 {
+    StartupTracer::Scope traceScope("createWebEngine");
     init_globalWebProfile();
 
     QSizePolicy widgetSize;
@@ -608,7 +767,20 @@ void MainWindow::createWebEngine()
     widgetSize.setHorizontalStretch(1);
     widgetSize.setVerticalStretch(1);
 
+    pageBridge = new PageBridge(this);
+    pageBridge->setQueuePolicy("setTheme", PageBridge::Coalesce);
+
+    pageStateBridge = new PageStateBridge(pageBridge, this);
+    connect(pageStateBridge, &PageStateBridge::unreadChanged, this, [=](int totalUnread){
+        bridgeUnreadCount = totalUnread;
+        updateTrayBadge();
+    });
+    connect(pageStateBridge, &PageStateBridge::chatListShown,
+            this, &StartupTracer::chatListShown);
+
+    StartupTracer::begin("Dictionaries::GetDictionaries");
     m_dictionaries = Dictionaries::GetDictionaries();
+    StartupTracer::end("Dictionaries::GetDictionaries");
 
     WebView *webEngine = new WebView(this,m_dictionaries);
     setCentralWidget(webEngine);
@@ -617,12 +789,85 @@ void MainWindow::createWebEngine()
 
     this->webEngine = webEngine;
 
+    // popups are pooled, they pick up palette changes through updateWindowTheme()
+    // one contact's avatar is scaled once, not on every message
+    avatarCache = new AvatarCache(4 * 1024 * 1024, this);
+    notificationManager = new NotificationManager(webEngine, this);
+    notificationManager->setAvatarCache(avatarCache);
+    connect(notificationManager, &NotificationManager::clicked, this, [=](){
+        if(windowState() == Qt::WindowMinimized || windowState() != Qt::WindowActive){
+            activateWindow();
+            raise();
+            showNormal();
+        }
+    });
+    notificationCoalescer = new NotificationCoalescer(this);
+    notificationCoalescer->setSink([=](CoalescedNotification &item){
+        showWebNotification(item);
+    });
+    reloadNotificationSettings();
+
     webEngine->addAction(minimizeAction);
     webEngine->addAction(lockAction);
     webEngine->addAction(quitAction);
 
     createWebPage(false);
 
+    lifecycleManager = new PageLifecycleManager(webEngine, this);
+
+    crashRecovery = new CrashRecovery(this);
+    connect(webEngine, &QWebEngineView::renderProcessTerminated, this,
+            [=](QWebEnginePage::RenderProcessTerminationStatus status, int exitCode){
+        // a discarded page has no renderer on purpose
+        if(lifecycleManager->state() == PageLifecycleManager::Discarded)
+            return;
+        crashRecovery->renderProcessTerminated(status, exitCode);
+    });
+    connect(crashRecovery, &CrashRecovery::reloadRequested,
+            this, &MainWindow::doAppReload);
+    healthMonitor = new PageHealthMonitor(webEngine, this);
+    connect(webEngine, &QWebEngineView::loadStarted,
+            healthMonitor, &PageHealthMonitor::reset);
+    connect(lifecycleManager, &PageLifecycleManager::stateChanged, this,
+            [=](PageLifecycleManager::State state){
+        healthMonitor->setPaused(state != PageLifecycleManager::Active);
+    });
+    connect(healthMonitor, &PageHealthMonitor::probed, this, [=](){
+        resourceMonitor.ifCreated([=](ResourceMonitorWidget *monitor){
+            monitor->setExtraInfo(diagnosticsText());
+        });
+    });
+
+    recoveryLadder = new RecoveryLadder(webEngine, this);
+    connect(healthMonitor, &PageHealthMonitor::responsivenessChanged,
+            recoveryLadder, &RecoveryLadder::setResponsive);
+    connect(recoveryLadder, &RecoveryLadder::storageWipeRequested, this, [=](){
+        const auto answer = QMessageBox::question(this, QApplication::applicationName(),
+                tr("WhatsApp Web still does not load correctly. Clearing its storage "
+                   "usually fixes this, but logs you out and restarts the app.\n\n"
+                   "Clear the storage now?"));
+        if(answer != QMessageBox::Yes){
+            recoveryLadder->storageWipeDeclined();
+            return;
+        }
+        utils::delete_cache(webEngine->page()->profile()->cachePath());
+        utils::delete_cache(webEngine->page()->profile()->persistentStoragePath());
+        settings.setValue("useragent",defaultUserAgentStr);
+        restartApp();
+    });
+    connect(recoveryLadder, &RecoveryLadder::exhausted, this, [=](const QString &reason){
+        utils * util = new utils(this);
+        util->DisplayExceptionErrorDialog(reason+" checkLoadedCorrectly()/RecoveryLadder all recovery steps failed, Quiting!\nUA: "+settings.value("useragent","DefaultUA").toString());
+
+        quitAction->trigger();
+    });
+
+    connect(crashRecovery, &CrashRecovery::crashLoopDetected, this, [=](){
+        notify(QApplication::applicationName(),
+               tr("The page keeps crashing, restarting with the low memory engine preset."));
+        QTimer::singleShot(3000, this, &MainWindow::restartApp);
+    });
+
 //    QWebEngineCookieStore *browser_cookie_store = this->webEngine->page()->profile()->cookieStore();
 //    connect( browser_cookie_store, &QWebEngineCookieStore::cookieAdded, this, &MainWindow::handleCookieAdded );
 
@@ -630,6 +875,7 @@ void MainWindow::createWebEngine()
 
 void MainWindow::createWebPage(bool offTheRecord)
 {
+    StartupTracer::Scope traceScope("createWebPage");
     if (offTheRecord && !m_otrProfile)
     {
         m_otrProfile.reset(new QWebEngineProfile);
@@ -652,17 +898,38 @@ void MainWindow::createWebPage(bool offTheRecord)
         page->setBackgroundColor(QColor("#F0F0F0")); //whatsapp light bg color
     }
     webEngine->setPage(page);
+    pageBridge->attach(page);
     //page should be set parent of profile to prevent
     //Release of profile requested but WebEnginePage still not deleted. Expect troubles !
     profile->setParent(page);
 
 //    RequestInterceptor *interceptor = new RequestInterceptor(profile);
 //    profile->setUrlRequestInterceptor(interceptor);
-    qsrand(time(NULL));
-    auto randomValue = qrand() % 300;
-    page->setUrl(QUrl("https://web.whatsapp.com?v="+QString::number(randomValue)));
+    // "canonical" lets the service worker and the http cache serve the shell, the
+    // cache-buster is kept for comparing warm starts (--trace-startup) and for recovery
+    QString navigationMode = settings.value("startup/navigationMode","canonical").toString();
+    StartupTracer::instant("navigationMode", navigationMode);
+    if(navigationMode == "cacheBuster"){
+        page->setUrl(WebEnginePage::cacheBustedHomeUrl());
+    }else{
+        page->setUrl(WebEnginePage::homeUrl());
+    }
+    // the profile outlives a reloaded page, connect it only once
+    profile->disconnect(profile, &QWebEngineProfile::downloadRequested, this, nullptr);
     connect(profile, &QWebEngineProfile::downloadRequested,
-        &m_downloadManagerWidget, &DownloadManagerWidget::downloadRequested);
+        this, [=](QWebEngineDownloadItem *download){
+        // downloads are started from the open chat
+        m_downloadManagerWidget->downloadRequested(download,
+                    pageStateBridge ? pageStateBridge->activeChat() : QString());
+    });
+    // interrupted downloads are requested again through the current page
+    m_downloadManagerWidget.ifCreated([=](DownloadManagerWidget *downloadManagerWidget){
+        downloadManagerWidget->setPage(page);
+    });
+    // those left over from the last session are picked up right away
+    if(settings.value("downloads/resume/pending/size",0).toInt() > 0){
+        m_downloadManagerWidget.get();
+    }
 
     connect(webEngine->page(), SIGNAL(fullScreenRequested(QWebEngineFullScreenRequest)),
                 this, SLOT(fullScreenRequested(QWebEngineFullScreenRequest)));
@@ -673,46 +940,63 @@ void MainWindow::createWebPage(bool offTheRecord)
 
 void MainWindow::setNotificationPresenter(QWebEngineProfile* profile)
 {
-    auto *op = webEngine->findChild<NotificationPopup*>("engineNotifier");
-    if( op != nullptr){
-        op->close();
-        op->deleteLater();
-    }
-
-    auto popup = new NotificationPopup(webEngine);
-    popup->setObjectName("engineNotifier");
-    connect(popup,&NotificationPopup::notification_clicked,[=](){
-        if(windowState()==Qt::WindowMinimized || windowState()!=Qt::WindowActive){
-            activateWindow();
-            raise();
-            showNormal();
-        }
+    // bursts from busy chats are merged and rate limited before anything is shown
+    profile->setNotificationPresenter([=] (std::unique_ptr<QWebEngineNotification> notification)
+    {
+        notificationCoalescer->add(std::move(notification));
     });
+}
 
-    profile->setNotificationPresenter([=] (std::unique_ptr<QWebEngineNotification> notification)
+void MainWindow::showWebNotification(CoalescedNotification &item)
+{
+    if(notificationBackend == 0 && trayIcon != nullptr)
     {
-        if(settings.value("disableNotificationPopups",false).toBool() == true){
-            return;
-        }
-        if(settings.value("notificationCombo",1).toInt() == 0 && trayIcon != nullptr)
-        {
-            QIcon icon(QPixmap::fromImage(notification->icon()));
-            trayIcon->showMessage(notification->title(),notification->message(),icon,settings.value("notificationTimeOut",9000).toInt());
-            trayIcon->disconnect(trayIcon,SIGNAL(messageClicked()));
-            connect(trayIcon,&QSystemTrayIcon::messageClicked,[=](){
-                if(windowState() == Qt::WindowMinimized || windowState() != Qt::WindowActive){
-                    activateWindow();
-                    raise();
-                    showNormal();
-                }
-            });
+        const QString title = item.title, message = item.message;
+        avatarCache->request(item.notification->icon(),64,this,[=](const AvatarCache::Avatar &avatar){
+            trayIcon->showMessage(title,message,QIcon(avatar.pixmap),notificationTimeOut);
+        });
+        trayIcon->disconnect(trayIcon,SIGNAL(messageClicked()));
+        connect(trayIcon,&QSystemTrayIcon::messageClicked,[=](){
+            if(windowState() == Qt::WindowMinimized || windowState() != Qt::WindowActive){
+                activateWindow();
+                raise();
+                showNormal();
+            }
+        });
 
-        }else{
-            popup->setMinimumWidth(300);
-            popup->present(notification);
-        }
+    }
+#ifdef Q_OS_LINUX
+    else if(notificationBackend == 2 && freedesktopNotifier && freedesktopNotifier->isAvailable())
+    {
+        freedesktopNotifier->show(item,notificationTimeOut);
+    }
+#endif
+    else{
+        // no notification daemon falls back to the popups
+        notificationManager->present(std::move(item.notification), item.count > 1 ? item.message : QString());
+    }
+}
 
-    });
+void MainWindow::reloadNotificationSettings()
+{
+    notificationBackend = settings.value("notificationCombo",1).toInt();
+    notificationTimeOut = settings.value("notificationTimeOut",9000).toInt();
+    notificationCoalescer->reloadSettings();
+    notificationManager->reloadSettings();
+
+#ifdef Q_OS_LINUX
+    if(notificationBackend == 2 && freedesktopNotifier == nullptr){
+        freedesktopNotifier = new FreedesktopNotifier(QDBusConnection::sessionBus(), this);
+        freedesktopNotifier->setAvatarCache(avatarCache);
+        connect(freedesktopNotifier,&FreedesktopNotifier::clicked,[=](){
+            if(windowState() == Qt::WindowMinimized || windowState() != Qt::WindowActive){
+                activateWindow();
+                raise();
+                showNormal();
+            }
+        });
+    }
+#endif
 }
 
 void MainWindow::fullScreenRequested(QWebEngineFullScreenRequest request)
@@ -733,31 +1017,54 @@ void MainWindow::handleWebViewTitleChanged(QString title)
 {
     setWindowTitle(title);
 
-    if (notificationsTitleRegExp.exactMatch(title))
-    {
-        if(notificationsTitleRegExp.isEmpty() == false){
-            QString capturedTitle = notificationsTitleRegExp.capturedTexts().first();
-            QRegExp rgex("\\([^\\d]*(\\d+)[^\\d]*\\)");
-            rgex.setMinimal(true);
-            if(rgex.indexIn(capturedTitle) != -1){
-                qDebug()<<rgex.capturedTexts();
-                QString unreadMessageCount = rgex.capturedTexts().last();
-                QString suffix = unreadMessageCount.toInt() > 1 ? tr("messages"): tr("message");
-                restoreAction->setText(tr("Restore")+" | "+unreadMessageCount+" "+suffix);
-            }
-        }
-        trayIcon->setIcon(trayIconUnread);
-        setWindowIcon(trayIconUnread);
-    }
-    else
-    {
-        trayIcon->setIcon(trayIconRead);
-        setWindowIcon(trayIconRead);
+    // the title flips constantly while contacts type, only act on a new count
+    int unreadCount = parseUnreadCount(title);
+    if(unreadCount == titleUnreadCount)
+        return;
+    titleUnreadCount = unreadCount;
+    updateTrayBadge();
+}
+
+void MainWindow::updateTrayBadge()
+{
+    // the bridge counts messages, the title only chats; the title is the
+    // fallback for when the page markup changed and the bridge sees nothing
+    int unreadCount = bridgeUnreadCount > 0 ? bridgeUnreadCount : qMax(0, titleUnreadCount);
+    if(unreadCount == shownUnreadCount)
+        return;
+    shownUnreadCount = unreadCount;
+    if(unreadCount > 0){
+        QString suffix = unreadCount > 1 ? tr("messages"): tr("message");
+        restoreAction->setText(tr("Restore")+" | "+QString::number(unreadCount)+" "+suffix);
+    }else{
+        restoreAction->setText(tr("&Restore"));
     }
+
+    bool darkTheme = settings.value("windowTheme","light").toString() == "dark";
+    QIcon icon = trayBadge.icon(unreadCount, darkTheme);
+    trayIcon->setIcon(icon);
+    setWindowIcon(icon);
 }
 
 void MainWindow::handleLoadFinished(bool loaded)
 {
+    if(firstLoadFinished == false){
+        firstLoadFinished = true;
+        StartupTracer::instant("firstLoadFinished", loaded ? "ok" : "failed");
+        StartupTracer::waitForChatList();
+
+        // secondary widgets are deferred until the page is up
+        QTimer::singleShot(0, this, [=](){
+            rateApp.get();
+            // the automatic theme switcher lives in SettingsWidget
+            if(settings.value("automaticTheme",false).toBool())
+                settingsWidget.get();
+        });
+    }
+    if(crashRecovery != nullptr)
+        crashRecovery->pageLoaded(loaded);
+    if(healthMonitor != nullptr)
+        healthMonitor->pageLoaded(loaded);
     if(loaded){
         //check if page has loaded correctly
         checkLoadedCorrectly();
@@ -776,18 +1083,15 @@ void MainWindow::checkLoadedCorrectly()
             {
                 qWarning()<<"Test 1 found"<<result.toString();
                 webEngine->page()->runJavaScript("document.getElementsByTagName('body')[0].innerText = ''");
-                loadingQuirk("test1");
+                recoveryLadder->escalate("test1");
             }else if(webEngine->title().contains("Error",Qt::CaseInsensitive))
             {
-                utils::delete_cache(webEngine->page()->profile()->cachePath());
-                utils::delete_cache(webEngine->page()->profile()->persistentStoragePath());
-                settings.setValue("useragent",defaultUserAgentStr);
-                utils * util = new utils(this);
-                util->DisplayExceptionErrorDialog("test1 handleWebViewTitleChanged(title) title: Error, Resetting UA, Quiting!\nUA: "+settings.value("useragent","DefaultUA").toString());
-
-                quitAction->trigger();
+                qWarning()<<"Test 1 error page, title:"<<webEngine->title();
+                // the storage wipe is the last tier, not the first answer
+                recoveryLadder->escalate("errorTitle");
             }else{
                 qWarning()<<"Test 1 Loaded correctly value:"<<result.toString();
+                recoveryLadder->pageHealthy();
             }
         });
 
@@ -797,7 +1101,7 @@ void MainWindow::checkLoadedCorrectly()
 //            [this](const QVariant &result){
 //                qWarning()<<"Test #1 Loaded correctly value:"<<result.toString();
 //                if(result.toString().contains("WhatsApp works with",Qt::CaseInsensitive)){
-//                    loadingQuirk("test2");
+//                    recoveryLadder->escalate("test2");
 //                }else if(webEngine->title().contains("Error",Qt::CaseInsensitive)){
 //                    utils::delete_cache(webEngine->page()->profile()->cachePath());
 //                    utils::delete_cache(webEngine->page()->profile()->persistentStoragePath());
@@ -812,24 +1116,6 @@ void MainWindow::checkLoadedCorrectly()
     }
 }
 
-void MainWindow::loadingQuirk(QString test)
-{
-    //contains ug message apply quirk
-    if(correctlyLoaderRetries > -1){
-        qWarning()<<test<<"checkLoadedCorrectly()/loadingQuirk()/doReload()"<<correctlyLoaderRetries;
-        doReload();
-        correctlyLoaderRetries--;
-    }else{
-        utils::delete_cache(webEngine->page()->profile()->cachePath());
-        utils::delete_cache(webEngine->page()->profile()->persistentStoragePath());
-        settings.setValue("useragent",defaultUserAgentStr);
-        utils * util = new utils(this);
-        util->DisplayExceptionErrorDialog(test+" checkLoadedCorrectly()/loadingQuirk() reload retries 0, Resetting UA, Quiting!\nUA: "+settings.value("useragent","DefaultUA").toString());
-
-        quitAction->trigger();
-    }
-}
-
 //unused direct method to download file without having entry in download manager
 void MainWindow::handleDownloadRequested(QWebEngineDownloadItem *download)
 {
@@ -873,11 +1159,15 @@ void MainWindow::messageClicked()
 
 void MainWindow::doAppReload()
 {
-
-    if(this->webEngine->page()){
-        this->webEngine->page()->disconnect();
+    QWebEnginePage *oldPage = this->webEngine->page();
+    if(oldPage){
+        oldPage->disconnect();
     }
     createWebPage(false);
+    // the profile was reparented to the new page, the old one can go
+    if(oldPage && oldPage != this->webEngine->page()){
+        oldPage->deleteLater();
+    }
 }
 
 void MainWindow::newChat()
@@ -916,7 +1206,12 @@ void MainWindow::toggleMute(const bool &checked)
 QString MainWindow::getPageTheme()
 {
     static QString theme = "web"; //implies light
-    if(webEngine && webEngine->page())
+    if(pageStateBridge && pageStateBridge->hasState())
+    {
+        theme = pageStateBridge->theme();
+        settings.setValue("windowTheme",theme);
+    }
+    else if(webEngine && webEngine->page())
     {
         webEngine->page()->runJavaScript(
             "document.querySelector('body').className;",
@@ -10,7 +10,6 @@
 #include <QMenu>
 #include <QMessageBox>
 #include <QProgressBar>
-#include <QRegExp>
 #include <QSettings>
 #include <QStatusBar>
 #include <QStyle>
@@ -25,6 +24,12 @@
 #include <QRadioButton>
 #include <QWebEngineContextMenuData>
 
+#include "avatarcache.h"
+#include "notificationcoalescer.h"
+#include "notificationmanager.h"
+#ifdef Q_OS_LINUX
+#include "freedesktopnotifier.h"
+#endif
 #include "notificationpopup.h"
 #include "requestinterceptor.h"
 #include "settingswidget.h"
@@ -32,10 +37,20 @@
 #include "lock.h"
 
 #include "downloadmanagerwidget.h"
+#include "downloadresumer.h"
 #include "about.h"
 #include "dictionaries.h"
 #include "webview.h"
 #include "rateapp.h"
+#include "lazywidget.h"
+#include "pagelifecyclemanager.h"
+#include "crashrecovery.h"
+#include "pagehealthmonitor.h"
+#include "recoveryladder.h"
+#include "traybadge.h"
+#include "pagebridge.h"
+#include "pagestatebridge.h"
+#include "resourcemonitor.h"
 
 
 class MainWindow : public QMainWindow
@@ -51,11 +66,17 @@ public slots:
     void handleLoadFinished(bool loaded);
     void handleDownloadRequested(QWebEngineDownloadItem *download);
     void loadAppWithArgument(const QString &arg);
+    void handleArguments(const QStringList &arguments);
 
+signals:
+    // hidden to the tray or shown again, minimizing does not count
+    void trayHiddenChanged(bool hidden);
 
 protected slots:
     void closeEvent(QCloseEvent *event) override;
     void resizeEvent(QResizeEvent *event);
+    void hideEvent(QHideEvent *event) override;
+    void showEvent(QShowEvent *event) override;
 private:
     QPalette lightPalette;
     void createActions();
@@ -64,9 +85,12 @@ private:
 
     QSettings settings;
 
-    QRegExp notificationsTitleRegExp;
     QIcon trayIconRead;
     QIcon trayIconUnread;
+    TrayBadgeRenderer trayBadge;
+    int titleUnreadCount = -1;
+    int bridgeUnreadCount = 0;
+    int shownUnreadCount = -1;
 
     QAction *reloadAction;
     QAction *minimizeAction;
@@ -77,24 +101,41 @@ private:
     QAction *lockAction;
     QAction *fullscreenAction;
     QAction *openUrlAction;
+    QAction *resourceMonitorAction;
 
     QMenu *trayIconMenu;
     QSystemTrayIcon *trayIcon;
 
     QWebEngineView *webEngine;
+    PageLifecycleManager *lifecycleManager = nullptr;
+    CrashRecovery *crashRecovery = nullptr;
+    PageHealthMonitor *healthMonitor = nullptr;
+    RecoveryLadder *recoveryLadder = nullptr;
+    AvatarCache *avatarCache = nullptr;
+    NotificationManager *notificationManager = nullptr;
+    NotificationCoalescer *notificationCoalescer = nullptr;
+#ifdef Q_OS_LINUX
+    FreedesktopNotifier *freedesktopNotifier = nullptr;
+#endif
+    int notificationBackend = 1;
+    int notificationTimeOut = 9000;
+    PageBridge *pageBridge = nullptr;
+    PageStateBridge *pageStateBridge = nullptr;
     //QStatusBar *statusBar;
 
 
-    SettingsWidget * settingsWidget = nullptr;
+    LazyWidget<SettingsWidget> settingsWidget;
+    LazyWidget<RateApp> rateApp;
+    LazyWidget<ResourceMonitorWidget> resourceMonitor;
 
     //void reload();
 
-    DownloadManagerWidget m_downloadManagerWidget;
+    LazyWidget<DownloadManagerWidget> m_downloadManagerWidget;
     QScopedPointer<QWebEngineProfile> m_otrProfile;
 
-    Lock *lockWidget = nullptr;
+    LazyWidget<Lock> lockWidget;
 
-    int correctlyLoaderRetries = 4;
+    bool firstLoadFinished = false;
 
     QStringList m_dictionaries;
 
@@ -106,6 +147,7 @@ private slots:
     void showAbout();
     void notify(QString title, QString message);
     void showSettings();
+    void showResourceMonitor();
     void handleCookieAdded(const QNetworkCookie &cookie);
 
     QString getPageTheme();
@@ -117,18 +159,26 @@ private slots:
 
     void createWebPage(bool offTheRecord =false);
     void init_settingWidget();
+    void init_downloadManagerWidget();
+    void init_rateApp();
+    void init_resourceMonitor();
     void init_globalWebProfile();
     void check_window_state();
     void init_lock();
+    void init_lockWidget();
     void lockApp();
 
 
     void checkLoadedCorrectly();
-    void loadingQuirk(QString test);
+    void updateTrayBadge();
+    QString diagnosticsText() const;
     void setNotificationPresenter(QWebEngineProfile *profile);
+    void showWebNotification(CoalescedNotification &item);
+    void reloadNotificationSettings();
     void newChat();
     bool isPhoneNumber(const QString &phoneNumber);
     void quitApp();
+    void restartApp();
 };
 
 #endif // MAINWINDOW_H
@@ -0,0 +1,139 @@
+#include "notificationcoalescer.h"
+
+namespace
+{
+    const int flushIntervalMs = 250;
+
+    // closing is reported to the page, deletion must wait, we may be in its signal
+    void discard(std::unique_ptr<QWebEngineNotification> &notification)
+    {
+        if (notification) {
+            notification->close();
+            notification.release()->deleteLater();
+        }
+    }
+}
+
+NotificationCoalescer::NotificationCoalescer(QObject *parent)
+    : QObject(parent)
+{
+    m_clock.start();
+    m_flushTimer.setInterval(flushIntervalMs);
+    connect(&m_flushTimer, &QTimer::timeout, this, &NotificationCoalescer::flushDue);
+    reloadSettings();
+}
+
+void NotificationCoalescer::setSink(Sink sink)
+{
+    m_sink = std::move(sink);
+}
+
+void NotificationCoalescer::reloadSettings()
+{
+    m_disabled = settings.value("disableNotificationPopups",false).toBool();
+    m_windowMs = qMax(0, settings.value("notificationCoalesceMs",1500).toInt());
+    m_burst = qMax(1, settings.value("notificationBurst",3).toInt());
+    m_refillMs = 60000 / qMax(1, settings.value("notificationMaxPerMinute",20).toInt());
+    m_tokens = qMin(m_tokens, double(m_burst));
+}
+
+QString NotificationCoalescer::statsText() const
+{
+    return tr("Notifications received: %1, shown: %2, merged: %3, rate limited: %4")
+            .arg(m_received).arg(m_shown).arg(m_merged).arg(m_rateLimited);
+}
+
+bool NotificationCoalescer::takeToken()
+{
+    const qint64 now = m_clock.elapsed();
+    m_tokens = qMin(double(m_burst), m_tokens + double(now - m_lastRefill) / m_refillMs);
+    m_lastRefill = now;
+    if (m_tokens < 1)
+        return false;
+    m_tokens -= 1;
+    return true;
+}
+
+void NotificationCoalescer::add(std::unique_ptr<QWebEngineNotification> notification)
+{
+    if (m_disabled || !notification)
+        return;
+    ++m_received;
+
+    const QString chat = notification->title();
+    const qint64 now = m_clock.elapsed();
+
+    auto pending = m_pending.find(chat);
+    if (pending != m_pending.end()) {
+        CoalescedNotification &item = pending->second.item;
+        discard(item.notification);
+        item.notification = std::move(notification);
+        ++item.count;
+        ++m_merged;
+        return;
+    }
+
+    auto windowEnd = m_windowEnds.find(chat);
+    const bool windowOpen = windowEnd != m_windowEnds.end() && windowEnd->second > now;
+
+    if (!windowOpen && takeToken()) {
+        CoalescedNotification item;
+        item.title = chat;
+        item.message = notification->message();
+        item.notification = std::move(notification);
+        emitItem(item);
+        return;
+    }
+
+    // wait for the window to end, or for a token
+    if (!windowOpen)
+        ++m_rateLimited;
+    Pending &entry = m_pending[chat];
+    entry.item.title = chat;
+    entry.item.notification = std::move(notification);
+    entry.dueAt = windowOpen ? windowEnd->second : now;
+    if (!m_flushTimer.isActive())
+        m_flushTimer.start();
+}
+
+void NotificationCoalescer::flushDue()
+{
+    const qint64 now = m_clock.elapsed();
+
+    for (auto it = m_pending.begin(); it != m_pending.end();) {
+        if (it->second.dueAt > now) {
+            ++it;
+            continue;
+        }
+        if (!takeToken())
+            break;
+        CoalescedNotification item = std::move(it->second.item);
+        it = m_pending.erase(it);
+        emitItem(item);
+    }
+
+    for (auto it = m_windowEnds.begin(); it != m_windowEnds.end();) {
+        if (it->second <= now && m_pending.find(it->first) == m_pending.end())
+            it = m_windowEnds.erase(it);
+        else
+            ++it;
+    }
+
+    if (m_pending.empty())
+        m_flushTimer.stop();
+}
+
+void NotificationCoalescer::emitItem(CoalescedNotification &item)
+{
+    if (item.count > 1)
+        item.message = tr("%1 new messages from %2").arg(item.count).arg(item.title);
+    else if (item.message.isEmpty() && item.notification)
+        item.message = item.notification->message();
+
+    ++m_shown;
+    m_windowEnds[item.title] = m_clock.elapsed() + m_windowMs;
+    if (m_sink)
+        m_sink(item);
+    else
+        discard(item.notification);
+}
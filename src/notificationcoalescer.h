@@ -0,0 +1,84 @@
+#ifndef NOTIFICATIONCOALESCER_H
+#define NOTIFICATIONCOALESCER_H
+
+#include <QElapsedTimer>
+#include <QObject>
+#include <QSettings>
+#include <QTimer>
+#include <QWebEngineNotification>
+
+#include <functional>
+#include <map>
+#include <memory>
+
+// What the coalescer hands on for display. count > 1 means several
+// notifications of one chat were merged, message is rewritten then.
+struct CoalescedNotification
+{
+    QString title;
+    QString message;
+    int count = 1;
+    std::unique_ptr<QWebEngineNotification> notification;   // the latest one
+};
+
+// Sits between the web notification presenter and the display backends.
+// The first notification of a chat is shown right away, further ones within
+// the coalescing window are merged into "N new messages from X" and shown
+// when it ends. A token bucket caps the popup rate over all chats, anything
+// over the cap keeps merging per chat until a token is free.
+//
+// Settings: notificationCoalesceMs (1500), notificationBurst (3),
+// notificationMaxPerMinute (20), disableNotificationPopups.
+class NotificationCoalescer : public QObject
+{
+    Q_OBJECT
+
+public:
+    using Sink = std::function<void(CoalescedNotification &)>;
+
+    explicit NotificationCoalescer(QObject *parent = nullptr);
+
+    void setSink(Sink sink);
+    void add(std::unique_ptr<QWebEngineNotification> notification);
+
+    int received() const { return m_received; }
+    int shown() const { return m_shown; }
+    int merged() const { return m_merged; }
+    int rateLimited() const { return m_rateLimited; }
+    QString statsText() const;
+
+public slots:
+    void reloadSettings();
+
+private:
+    struct Pending {
+        CoalescedNotification item;
+        qint64 dueAt = 0;
+    };
+
+    bool takeToken();
+    void emitItem(CoalescedNotification &item);
+    void flushDue();
+
+    QSettings settings;
+    Sink m_sink;
+    QTimer m_flushTimer;
+    QElapsedTimer m_clock;
+
+    std::map<QString, Pending> m_pending;
+    std::map<QString, qint64> m_windowEnds;   // chat -> end of its open window
+
+    bool m_disabled = false;
+    int m_windowMs = 1500;
+    int m_burst = 3;
+    int m_refillMs = 3000;
+    double m_tokens = 3;
+    qint64 m_lastRefill = 0;
+
+    int m_received = 0;
+    int m_shown = 0;
+    int m_merged = 0;
+    int m_rateLimited = 0;
+};
+
+#endif // NOTIFICATIONCOALESCER_H
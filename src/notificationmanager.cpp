@@ -0,0 +1,152 @@
+#include "notificationmanager.h"
+
+#include "avatarcache.h"
+#include "notificationpopup.h"
+
+#include <QApplication>
+#include <QDesktopWidget>
+
+namespace
+{
+    const int maxQueued   = 20;
+    const int topMargin   = 40;
+    const int rightMargin = 10;
+    const int spacing     = 8;
+    const int popupWidth  = 300;
+}
+
+NotificationManager::NotificationManager(QWidget *popupParent, QObject *parent)
+    : QObject(parent),
+      m_popupParent(popupParent)
+{
+    m_layoutTimer.setSingleShot(true);
+    m_layoutTimer.setInterval(0);
+    connect(&m_layoutTimer, &QTimer::timeout, this, &NotificationManager::layout);
+
+    reloadSettings();
+}
+
+void NotificationManager::setAvatarCache(AvatarCache *avatars)
+{
+    m_avatars = avatars;
+}
+
+int NotificationManager::visibleCount() const
+{
+    return m_stack.size();
+}
+
+int NotificationManager::queuedCount() const
+{
+    return int(m_queue.size());
+}
+
+void NotificationManager::reloadSettings()
+{
+    m_timeoutMs = settings.value("notificationTimeOut",9000).toInt();
+    m_maxVisible = qMax(1, settings.value("notificationMaxVisible",3).toInt());
+}
+
+void NotificationManager::notify(const QString &title, const QString &message, const QPixmap &image)
+{
+    Pending pending;
+    pending.title = title;
+    pending.message = message;
+    pending.image = image;
+    enqueue(std::move(pending));
+}
+
+void NotificationManager::present(std::unique_ptr<QWebEngineNotification> notification,
+                                  const QString &message)
+{
+    Pending pending;
+    pending.message = message;
+    pending.notification = std::move(notification);
+    enqueue(std::move(pending));
+}
+
+void NotificationManager::enqueue(Pending &&pending)
+{
+    if (int(m_queue.size()) >= maxQueued) {
+        // busy group chat, the oldest waiting notification is stale anyway
+        if (m_queue.front().notification)
+            m_queue.front().notification->close();
+        m_queue.pop_front();
+    }
+    m_queue.push_back(std::move(pending));
+    m_layoutTimer.start();
+}
+
+void NotificationManager::closeAll()
+{
+    for (Pending &pending : m_queue) {
+        if (pending.notification)
+            pending.notification->close();
+    }
+    m_queue.clear();
+    // popups report back through popupFinished(), work on a copy
+    const QVector<NotificationPopup *> visible = m_stack;
+    for (NotificationPopup *popup : visible)
+        popup->dismiss();
+}
+
+NotificationPopup *NotificationManager::takePopup()
+{
+    if (!m_pool.isEmpty())
+        return m_pool.takeLast();
+
+    NotificationPopup *popup = new NotificationPopup(m_popupParent);
+    popup->setMinimumWidth(popupWidth);
+    popup->setPalette(qApp->palette());
+    connect(popup, &NotificationPopup::notification_clicked, this, &NotificationManager::clicked);
+    connect(popup, &NotificationPopup::finished, this, &NotificationManager::popupFinished);
+    return popup;
+}
+
+void NotificationManager::popupFinished(NotificationPopup *popup)
+{
+    m_stack.removeOne(popup);
+    m_pool.append(popup);
+    m_layoutTimer.start();
+}
+
+// top left corner of a popup offset pixels below the first one
+QPoint NotificationManager::slotPosition(const NotificationPopup *popup, int offset) const
+{
+    const QRect screen = QApplication::desktop()->availableGeometry(m_popupParent);
+    return QPoint(screen.right() - (popup->width() + rightMargin), screen.top() + topMargin + offset);
+}
+
+void NotificationManager::layout()
+{
+    // move the remaining popups up, then fill free slots from the queue
+    int offset = 0;
+    for (NotificationPopup *popup : qAsConst(m_stack)) {
+        popup->slideTo(slotPosition(popup, offset));
+        offset += popup->height() + spacing;
+    }
+
+    while (m_stack.size() < m_maxVisible && !m_queue.empty()) {
+        Pending pending = std::move(m_queue.front());
+        m_queue.pop_front();
+
+        NotificationPopup *popup = takePopup();
+        if (pending.notification) {
+            const QImage icon = pending.notification->icon();
+            popup->setNotification(std::move(pending.notification), pending.message);
+            if (m_avatars) {
+                const quint64 generation = popup->generation();
+                m_avatars->request(icon, NotificationPopup::iconHeight(), popup,
+                                   [popup, generation](const AvatarCache::Avatar &avatar) {
+                    if (popup->generation() == generation)
+                        popup->setIcon(avatar.pixmap);
+                });
+            }
+        } else
+            popup->setContent(pending.title, pending.message, pending.image);
+
+        popup->present(slotPosition(popup, offset), m_timeoutMs);
+        offset += popup->height() + spacing;
+        m_stack.append(popup);
+    }
+}
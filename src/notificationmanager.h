@@ -0,0 +1,72 @@
+#ifndef NOTIFICATIONMANAGER_H
+#define NOTIFICATIONMANAGER_H
+
+#include <QImage>
+#include <QObject>
+#include <QPixmap>
+#include <QSettings>
+#include <QTimer>
+#include <QVector>
+#include <QWebEngineNotification>
+
+#include <deque>
+#include <memory>
+
+class AvatarCache;
+class NotificationPopup;
+
+// Shows in-app notification popups stacked below each other in the top right
+// corner. Popups come from a pool and are reused, at most maxVisible are on
+// screen, the rest wait in a bounded queue and move up as others close.
+// Layout runs from a zero timer, never from inside a popup's own signal.
+class NotificationManager : public QObject
+{
+    Q_OBJECT
+
+public:
+    explicit NotificationManager(QWidget *popupParent, QObject *parent = nullptr);
+
+    void setAvatarCache(AvatarCache *avatars);
+
+    void notify(const QString &title, const QString &message, const QPixmap &image);
+    void present(std::unique_ptr<QWebEngineNotification> notification,
+                 const QString &message = QString());
+
+    int visibleCount() const;
+    int queuedCount() const;
+
+public slots:
+    void reloadSettings();
+    void closeAll();
+
+signals:
+    void clicked();
+
+private:
+    struct Pending {
+        QString title;
+        QString message;
+        QPixmap image;
+        std::unique_ptr<QWebEngineNotification> notification;
+    };
+
+    void enqueue(Pending &&pending);
+    void popupFinished(NotificationPopup *popup);
+    void layout();
+    NotificationPopup *takePopup();
+    QPoint slotPosition(const NotificationPopup *popup, int offset) const;
+
+    QWidget *m_popupParent;
+    AvatarCache *m_avatars = nullptr;
+    QSettings settings;
+    QTimer m_layoutTimer;
+
+    QVector<NotificationPopup *> m_pool;     // idle, hidden
+    QVector<NotificationPopup *> m_stack;    // on screen, top to bottom
+    std::deque<Pending> m_queue;
+
+    int m_timeoutMs = 9000;
+    int m_maxVisible = 3;
+};
+
+#endif // NOTIFICATIONMANAGER_H
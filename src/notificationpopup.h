@@ -16,24 +16,30 @@
 #include <QDesktopWidget>
 #include <QDebug>
 #include "widgets/scrolltext/scrolltext.h"
-#include <QSettings>
 
 #include <memory>
 
+// A single popup, owned and reused by NotificationManager. It never deletes
+// itself: closing (timeout, click, close button, web notification closed)
+// hides it and emits finished() so the manager can put it back in the pool.
 class NotificationPopup : public QWidget
 {
     Q_OBJECT
 
     QLabel m_icon, m_title; ScrollText m_message;
     std::unique_ptr<QWebEngineNotification> notification;
-    QSettings settings;
+    QTimer m_closeTimer;
+    QPropertyAnimation m_slide;
+    quint64 m_generation = 0;
 
 public:
-    NotificationPopup(QWidget *parent) : QWidget(parent)
+    NotificationPopup(QWidget *parent) : QWidget(parent), m_slide(this, "pos")
     {
         setWindowFlags(Qt::ToolTip);
         auto rootLayout = new QHBoxLayout(this);
 
+        m_icon.setFixedSize(iconHeight(), iconHeight());
+        m_icon.setAlignment(Qt::AlignCenter);
         rootLayout->addWidget(&m_icon);
 
         auto bodyLayout = new QVBoxLayout;
@@ -50,85 +56,93 @@ public:
         connect(close, &QPushButton::clicked, this, &NotificationPopup::onClosed);
 
         bodyLayout->addWidget(&m_message);
-        adjustSize();
-    }
-
-    void present(QString title,QString message,const QPixmap image)
-    {
-        m_title.setText("<b>" + title + "</b>");
-        m_message.setText(message);
-        m_icon.setPixmap(image.scaledToHeight(m_icon.height(),Qt::SmoothTransformation));
 
-        this->adjustSize();
-        qApp->processEvents();
+        m_closeTimer.setSingleShot(true);
+        connect(&m_closeTimer, &QTimer::timeout, this, &NotificationPopup::onClosed);
 
-        int x = QApplication::desktop()->geometry().width()-(this->width()+10);
-        int y = 40;
+        m_slide.setDuration(200);
+        m_slide.setEasingCurve(QEasingCurve::Linear);
 
+        adjustSize();
+    }
 
-        this->update();
-
-        QTimer::singleShot(settings.value("notificationTimeOut",9000).toInt(),this,[=](){
-            onClosed();
-        });
-
-        QPropertyAnimation *a = new QPropertyAnimation(this,"pos");
-        a->setDuration(200);
-        a->setStartValue(QApplication::desktop()->mapToGlobal(QPoint(x+this->width(),y)));
-        a->setEndValue(QApplication::desktop()->mapToGlobal(QPoint(x,y)));
-        a->setEasingCurve(QEasingCurve::Linear);
-        a->start(QPropertyAnimation::DeleteWhenStopped);
+    static int iconHeight() { return 48; }
 
-        this->show();
+    // changes with every new content, to drop icons that arrive too late
+    quint64 generation() const { return m_generation; }
 
+    void setContent(const QString &title, const QString &message, const QPixmap &image)
+    {
+        ++m_generation;
+        m_title.setText("<b>" + title + "</b>");
+        m_message.setText(message);
+        m_icon.setPixmap(image.scaledToHeight(iconHeight(),Qt::SmoothTransformation));
+        updateSize();
     }
 
-    void present(std::unique_ptr<QWebEngineNotification> &newNotification)
+    // already scaled to iconHeight(), see AvatarCache
+    void setIcon(const QPixmap &icon)
     {
-        if (notification) {
-            notification->close();
-            notification.reset();
-        }
+        m_icon.setPixmap(icon);
+    }
 
-        notification.swap(newNotification);
+    // message overrides the notification's own text, e.g. for merged notifications
+    void setNotification(std::unique_ptr<QWebEngineNotification> newNotification,
+                         const QString &message = QString())
+    {
+        ++m_generation;
+        releaseNotification();
+        notification = std::move(newNotification);
 
         m_title.setText("<b>" + notification->title() + "</b>");
-        m_message.setText(notification->message());
-        m_icon.setPixmap(QPixmap::fromImage(notification->icon()).scaledToHeight(m_icon.height()));
-
-        //show();
-        notification->show();
+        m_message.setText(message.isEmpty() ? notification->message() : message);
+        // the avatar is set by the manager once it is scaled
+        m_icon.clear();
 
         connect(notification.get(), &QWebEngineNotification::closed, this, &NotificationPopup::onClosed);
-        QTimer::singleShot(settings.value("notificationTimeOut",9000).toInt(), notification.get(), [&] () { onClosed(); });
-
-        this->adjustSize();
-        qApp->processEvents();
+        notification->show();
+        updateSize();
+    }
 
-        int x = QApplication::desktop()->geometry().width()-(this->width()+10);
-        int y = 40;
+    // slides in from the right edge to pos
+    void present(const QPoint &pos, int timeoutMs)
+    {
+        m_slide.stop();
+        m_slide.setStartValue(QPoint(pos.x() + width(), pos.y()));
+        m_slide.setEndValue(pos);
+        move(m_slide.startValue().toPoint());
+        show();
+        m_slide.start();
+        m_closeTimer.start(timeoutMs);
+    }
 
-        this->update();
+    // restacking after another popup closed
+    void slideTo(const QPoint &pos)
+    {
+        if (m_slide.state() == QAbstractAnimation::Running && m_slide.endValue().toPoint() == pos)
+            return;
+        m_slide.stop();
+        m_slide.setStartValue(this->pos());
+        m_slide.setEndValue(pos);
+        m_slide.start();
+    }
 
-        QPropertyAnimation *a = new QPropertyAnimation(this,"pos");
-        a->setDuration(200);
-        a->setStartValue(QApplication::desktop()->mapToGlobal(QPoint(x+this->width(),y)));
-        a->setEndValue(QApplication::desktop()->mapToGlobal(QPoint(x,y)));
-        a->setEasingCurve(QEasingCurve::Linear);
-        a->start(QPropertyAnimation::DeleteWhenStopped);
-        this->show();
+public slots:
+    void dismiss()
+    {
+        onClosed();
     }
 
 protected slots:
     void onClosed()
     {
+        if (isHidden() && !notification)
+            return;
+        m_closeTimer.stop();
+        m_slide.stop();
         hide();
-        if(notification){
-            notification->close();
-            notification.reset();
-        }else{
-            this->deleteLater();
-        }
+        releaseNotification();
+        emit finished(this);
     }
 
 protected:
@@ -143,8 +157,29 @@ protected:
             onClosed();
         }
     }
+
+private:
+    void updateSize()
+    {
+        // layouts are computed synchronously, no need to spin the event loop
+        ensurePolished();
+        layout()->activate();
+        adjustSize();
+    }
+
+    void releaseNotification()
+    {
+        if (notification) {
+            notification->disconnect(this);
+            notification->close();
+            // may be inside its closed() signal, do not delete it synchronously
+            notification.release()->deleteLater();
+        }
+    }
+
 signals:
     void notification_clicked();
+    void finished(NotificationPopup *popup);
 };
 
 #endif // NOTIFICATIONPOPUP_H
@@ -0,0 +1,221 @@
+#include "pagebridge.h"
+
+#include <QDateTime>
+#include <QDebug>
+#include <QFile>
+#include <QWebChannel>
+#include <QWebEnginePage>
+#include <QWebEngineScript>
+#include <QWebEngineScriptCollection>
+
+namespace
+{
+    const int frameMs     = 16;
+    const int maxQueued   = 256;
+    const int maxInFlight = 4;
+
+    QString readResource(const QString &path)
+    {
+        QFile file(path);
+        if (!file.open(QIODevice::ReadOnly)) {
+            qWarning() << "PageBridge: cannot read" << path;
+            return QString();
+        }
+        return QString::fromUtf8(file.readAll());
+    }
+}
+
+PageBridge::PageBridge(QObject *parent)
+    : QObject(parent)
+{
+    m_channel = new QWebChannel(this);
+    m_channel->registerObject(QStringLiteral("whatsiePageBridge"), this);
+
+    m_flushTimer.setSingleShot(true);
+    m_flushTimer.setInterval(frameMs);
+    connect(&m_flushTimer, &QTimer::timeout, this, &PageBridge::flush);
+
+    m_clock.start();
+}
+
+void PageBridge::addScript(const QString &resourcePath)
+{
+    m_scripts.append(resourcePath);
+}
+
+void PageBridge::attach(QWebEnginePage *page)
+{
+    // qwebchannel.js is built into Qt WebEngine, everything runs in the
+    // application world so page scripts can not reach the bridge
+    QString source = readResource(":/qtwebchannel/qwebchannel.js")
+            + "\n" + readResource(":/scripts/pagebridge.js");
+    for (const QString &script : qAsConst(m_scripts))
+        source += "\n" + readResource(script);
+
+    QWebEngineScript script;
+    script.setName(QStringLiteral("whatsie-pagebridge"));
+    script.setSourceCode(source);
+    script.setInjectionPoint(QWebEngineScript::DocumentReady);
+    script.setWorldId(QWebEngineScript::ApplicationWorld);
+    script.setRunsOnSubFrames(false);
+    page->scripts().insert(script);
+
+    page->setWebChannel(m_channel, QWebEngineScript::ApplicationWorld);
+
+    // batches sent to the previous page will never be acknowledged
+    m_connected = false;
+    m_inFlight.clear();
+}
+
+bool PageBridge::isConnected() const
+{
+    return m_connected;
+}
+
+void PageBridge::setQueuePolicy(const QString &type, QueuePolicy policy)
+{
+    m_policies.insert(type, policy);
+}
+
+void PageBridge::post(const QString &type, const QVariant &payload)
+{
+    const QueuePolicy policy = m_policies.value(type, DropOldest);
+    TypeStats &stats = m_stats[type];
+
+    if (policy == Coalesce) {
+        for (Outgoing &waiting : m_queue) {
+            if (waiting.type == type) {
+                waiting.payload = payload;
+                ++stats.coalesced;
+                return;
+            }
+        }
+    }
+
+    if (m_queue.size() >= maxQueued) {
+        if (policy == DropNewest) {
+            ++stats.dropped;
+            return;
+        }
+        ++m_stats[m_queue.first().type].dropped;
+        m_queue.removeFirst();
+    }
+
+    m_queue.append({type, payload, m_clock.elapsed()});
+    schedule();
+}
+
+void PageBridge::schedule()
+{
+    if (m_connected && !m_flushTimer.isActive())
+        m_flushTimer.start();
+}
+
+void PageBridge::flush()
+{
+    if (!m_connected || m_queue.isEmpty() || m_inFlight.size() >= maxInFlight)
+        return;
+
+    const int seq = m_nextSeq++;
+    QVariantList messages;
+    QStringList types;
+    messages.reserve(m_queue.size());
+    for (const Outgoing &message : qAsConst(m_queue)) {
+        QVariantMap entry;
+        entry.insert("type", message.type);
+        entry.insert("payload", message.payload);
+        messages.append(entry);
+        types.append(message.type);
+        ++m_stats[message.type].sent;
+    }
+    m_queue.clear();
+
+    m_inFlight.insert(seq, qMakePair(m_clock.elapsed(), types));
+
+    QVariantMap batch;
+    batch.insert("version", ProtocolVersion);
+    batch.insert("seq", seq);
+    batch.insert("messages", messages);
+    emit deliver(batch);
+}
+
+void PageBridge::hello(int version)
+{
+    if (version != ProtocolVersion) {
+        qWarning() << "PageBridge: page speaks version" << version << "expected" << ProtocolVersion;
+        return;
+    }
+    // a new document, batches sent to the previous one are lost
+    m_inFlight.clear();
+    m_connected = true;
+    emit connected();
+    schedule();
+}
+
+void PageBridge::ack(int seq)
+{
+    if (!m_inFlight.contains(seq))
+        return;
+    const QPair<qint64, QStringList> sent = m_inFlight.take(seq);
+    const qint64 latency = m_clock.elapsed() - sent.first;
+    for (const QString &type : sent.second) {
+        TypeStats &stats = m_stats[type];
+        stats.totalLatencyMs += latency;
+        stats.maxLatencyMs = qMax(stats.maxLatencyMs, latency);
+    }
+    schedule();
+}
+
+void PageBridge::receive(const QVariantMap &batch)
+{
+    if (batch.value("version").toInt() != ProtocolVersion) {
+        qWarning() << "PageBridge: dropping batch of version" << batch.value("version");
+        return;
+    }
+    if (batch.value("dropped").toInt() > 0)
+        qWarning() << "PageBridge: page dropped" << batch.value("dropped").toInt() << "messages";
+
+    const qint64 now = QDateTime::currentMSecsSinceEpoch();
+    const QVariantList messages = batch.value("messages").toList();
+    for (const QVariant &item : messages) {
+        const QVariantMap message = item.toMap();
+        const QString type = message.value("type").toString();
+
+        TypeStats &stats = m_stats[type];
+        ++stats.received;
+        const qint64 latency = qMax<qint64>(0, now - message.value("sentAt").toLongLong());
+        stats.totalLatencyMs += latency;
+        stats.maxLatencyMs = qMax(stats.maxLatencyMs, latency);
+
+        auto handler = m_handlers.constFind(type);
+        if (handler == m_handlers.constEnd()) {
+            qWarning() << "PageBridge: no handler for" << type;
+            continue;
+        }
+        handler.value()(message.value("payload"));
+    }
+}
+
+QHash<QString, PageBridge::TypeStats> PageBridge::stats() const
+{
+    return m_stats;
+}
+
+QString PageBridge::statsText() const
+{
+    QStringList lines;
+    for (auto it = m_stats.constBegin(); it != m_stats.constEnd(); ++it) {
+        const TypeStats &stats = it.value();
+        const int messages = stats.received + stats.sent;
+        lines.append(tr("%1: %2 in, %3 out, %4 dropped, %5 coalesced, latency avg %6 ms max %7 ms")
+                     .arg(it.key())
+                     .arg(stats.received)
+                     .arg(stats.sent)
+                     .arg(stats.dropped)
+                     .arg(stats.coalesced)
+                     .arg(messages > 0 ? stats.totalLatencyMs / messages : 0)
+                     .arg(stats.maxLatencyMs));
+    }
+    lines.sort();
+    return lines.join("\n");
+}
@@ -0,0 +1,110 @@
+#ifndef PAGEBRIDGE_H
+#define PAGEBRIDGE_H
+
+#include <QElapsedTimer>
+#include <QHash>
+#include <QObject>
+#include <QStringList>
+#include <QTimer>
+#include <QVariant>
+#include <QVector>
+
+#include <functional>
+
+QT_BEGIN_NAMESPACE
+class QWebChannel;
+class QWebEnginePage;
+QT_END_NAMESPACE
+
+// Message bridge between C++ and the page over QWebChannel, the page side is
+// scripts/pagebridge.js (window.whatsie). Features register typed handlers
+// for messages from the page and post() messages to it instead of building
+// runJavaScript strings.
+//
+// Both directions are batched, the page per animation frame, C++ per frame
+// interval, and every batch carries ProtocolVersion. Outgoing messages wait in
+// a bounded queue, the policy of a type decides what happens when it is full
+// or a message of that type is already waiting. At most maxInFlight batches
+// are unacknowledged by the page, further messages queue up (backpressure).
+class PageBridge : public QObject
+{
+    Q_OBJECT
+
+public:
+    static const int ProtocolVersion = 1;
+
+    enum QueuePolicy {
+        DropNewest,     // queue full: the new message is dropped
+        DropOldest,     // queue full: the oldest waiting message is dropped
+        Coalesce        // a waiting message of the same type is replaced
+    };
+    Q_ENUM(QueuePolicy)
+
+    struct TypeStats {
+        int received = 0;
+        int sent = 0;
+        int dropped = 0;
+        int coalesced = 0;
+        qint64 totalLatencyMs = 0;
+        qint64 maxLatencyMs = 0;
+    };
+
+    explicit PageBridge(QObject *parent = nullptr);
+
+    // Feature scripts, injected after the bridge script. Call before attach().
+    void addScript(const QString &resourcePath);
+    // Installs the channel and the scripts, call for every new page.
+    void attach(QWebEnginePage *page);
+    bool isConnected() const;
+
+    void setQueuePolicy(const QString &type, QueuePolicy policy);
+    void post(const QString &type, const QVariant &payload = QVariant());
+
+    // Handler for messages of type from the page, payload converted to T.
+    template <typename T>
+    void on(const QString &type, std::function<void(const T &)> handler)
+    {
+        m_handlers.insert(type, [handler](const QVariant &payload) {
+            handler(payload.value<T>());
+        });
+    }
+
+    QHash<QString, TypeStats> stats() const;
+    QString statsText() const;
+
+public slots:
+    // called from the page
+    void hello(int version);
+    void receive(const QVariantMap &batch);
+    void ack(int seq);
+
+signals:
+    // to the page
+    void deliver(const QVariantMap &batch);
+    void connected();
+
+private:
+    struct Outgoing {
+        QString type;
+        QVariant payload;
+        qint64 queuedAt;
+    };
+
+    void flush();
+    void schedule();
+
+    QWebChannel *m_channel;
+    QStringList m_scripts;
+    QHash<QString, std::function<void(const QVariant &)>> m_handlers;
+    QHash<QString, QueuePolicy> m_policies;
+    QHash<QString, TypeStats> m_stats;
+
+    QVector<Outgoing> m_queue;
+    QHash<int, QPair<qint64, QStringList>> m_inFlight;   // seq -> sent at, types
+    QTimer m_flushTimer;
+    QElapsedTimer m_clock;
+    int m_nextSeq = 1;
+    bool m_connected = false;
+};
+
+#endif // PAGEBRIDGE_H
@@ -0,0 +1,185 @@
+#include "pagehealthmonitor.h"
+
+#include <QDebug>
+#include <QPointer>
+#include <QWebEnginePage>
+#include <QWebEngineScript>
+#include <QWebEngineView>
+
+namespace
+{
+    const int windowSize = 120;
+
+    int bucketFor(qint64 latencyMs)
+    {
+        int bucket = 0;
+        while (bucket < PageHealthMonitor::BucketCount - 1 && latencyMs >= (qint64(1) << bucket))
+            ++bucket;
+        return bucket;
+    }
+}
+
+PageHealthMonitor::PageHealthMonitor(QWebEngineView *view, QObject *parent)
+    : QObject(parent),
+      m_view(view)
+{
+    m_timeoutTimer.setSingleShot(true);
+    m_window.reserve(windowSize);
+
+    connect(&m_probeTimer, &QTimer::timeout, this, &PageHealthMonitor::probe);
+    connect(&m_timeoutTimer, &QTimer::timeout, this, &PageHealthMonitor::probeTimedOut);
+
+    reloadSettings();
+}
+
+bool PageHealthMonitor::isResponsive() const
+{
+    return m_responsive;
+}
+
+qint64 PageHealthMonitor::lastLatencyMs() const
+{
+    return m_lastLatencyMs;
+}
+
+int PageHealthMonitor::timeouts() const
+{
+    return m_timeouts;
+}
+
+QVector<int> PageHealthMonitor::histogram() const
+{
+    QVector<int> counts(BucketCount);
+    for (int i = 0; i < BucketCount; ++i)
+        counts[i] = m_counts[i];
+    return counts;
+}
+
+qint64 PageHealthMonitor::percentileMs(double percentile) const
+{
+    if (m_window.isEmpty())
+        return -1;
+    const int wanted = qMax(1, qRound(m_window.size() * percentile / 100.0));
+    int seen = 0;
+    for (int i = 0; i < BucketCount; ++i) {
+        seen += m_counts[i];
+        if (seen >= wanted)
+            return qint64(1) << i;
+    }
+    return qint64(1) << (BucketCount - 1);
+}
+
+QString PageHealthMonitor::statsText() const
+{
+    if (m_window.isEmpty())
+        return tr("Page health: no probes yet");
+    return tr("Page health: %1, last round trip %2 ms, p50 < %3 ms, p95 < %4 ms, %5 timeouts")
+            .arg(m_responsive ? tr("responsive") : tr("unresponsive"))
+            .arg(m_lastLatencyMs)
+            .arg(percentileMs(50))
+            .arg(percentileMs(95))
+            .arg(m_timeouts);
+}
+
+void PageHealthMonitor::reloadSettings()
+{
+    m_probeTimer.setInterval(settings.value("health/probeIntervalSeconds", 15).toInt() * 1000);
+    m_timeoutTimer.setInterval(settings.value("health/probeTimeoutMs", 10000).toInt());
+    m_hangThresholdMs = settings.value("health/hangThresholdMs", 2000).toInt();
+    updateTimer();
+}
+
+void PageHealthMonitor::reset()
+{
+    m_pending = 0;
+    m_loaded = false;
+    m_timeoutTimer.stop();
+    setResponsive(true);
+    updateTimer();
+}
+
+void PageHealthMonitor::pageLoaded(bool ok)
+{
+    m_loaded = ok;
+    updateTimer();
+}
+
+void PageHealthMonitor::setPaused(bool paused)
+{
+    m_paused = paused;
+    if (paused) {
+        // a frozen renderer does not answer, that is not a hang
+        m_pending = 0;
+        m_timeoutTimer.stop();
+    }
+    updateTimer();
+}
+
+void PageHealthMonitor::updateTimer()
+{
+    if (m_loaded && !m_paused && m_probeTimer.interval() > 0) {
+        if (!m_probeTimer.isActive())
+            m_probeTimer.start();
+    } else {
+        m_probeTimer.stop();
+    }
+}
+
+void PageHealthMonitor::probe()
+{
+    if (m_pending != 0 || m_view == nullptr || m_view->page() == nullptr)
+        return;
+
+    const quint64 sequence = ++m_sequence;
+    m_pending = sequence;
+    m_sinceProbe.start();
+    m_timeoutTimer.start();
+
+    QPointer<PageHealthMonitor> self(this);
+    m_view->page()->runJavaScript("1", QWebEngineScript::ApplicationWorld,
+                                  [self, sequence](const QVariant &) {
+        // late answers from an earlier page or a timed out probe are dropped
+        if (self.isNull() || self->m_pending != sequence)
+            return;
+        self->m_pending = 0;
+        self->m_timeoutTimer.stop();
+        self->record(self->m_sinceProbe.elapsed());
+    });
+}
+
+void PageHealthMonitor::probeTimedOut()
+{
+    if (m_pending == 0)
+        return;
+    m_pending = 0;
+    ++m_timeouts;
+    qWarning() << "Page did not answer a health probe within" << m_timeoutTimer.interval() << "ms";
+    record(m_sinceProbe.elapsed());
+}
+
+void PageHealthMonitor::record(qint64 latencyMs)
+{
+    const quint8 bucket = quint8(bucketFor(latencyMs));
+    if (m_window.size() < windowSize) {
+        m_window.append(bucket);
+    } else {
+        --m_counts[m_window.at(m_windowPos)];
+        m_window[m_windowPos] = bucket;
+        m_windowPos = (m_windowPos + 1) % windowSize;
+    }
+    ++m_counts[bucket];
+
+    m_lastLatencyMs = latencyMs;
+    setResponsive(latencyMs <= m_hangThresholdMs);
+    emit probed(latencyMs);
+}
+
+void PageHealthMonitor::setResponsive(bool responsive)
+{
+    if (responsive == m_responsive)
+        return;
+    m_responsive = responsive;
+    if (!responsive)
+        qWarning() << "Page flagged unresponsive, last round trip" << m_lastLatencyMs << "ms";
+    emit responsivenessChanged(responsive);
+}
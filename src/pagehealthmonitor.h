@@ -0,0 +1,82 @@
+#ifndef PAGEHEALTHMONITOR_H
+#define PAGEHEALTHMONITOR_H
+
+#include <QElapsedTimer>
+#include <QObject>
+#include <QSettings>
+#include <QTimer>
+#include <QVector>
+
+QT_BEGIN_NAMESPACE
+class QWebEngineView;
+QT_END_NAMESPACE
+
+// Measures the runJavaScript round trip to the renderer at a fixed interval
+// and keeps a histogram over the last probes. A probe slower than the hang
+// threshold, or one that does not return at all, marks the page as
+// unresponsive until a probe comes back in time again.
+//
+// Probes run in the application world so page scripts cannot interfere,
+// only while a loaded page is active (not frozen or discarded).
+//
+// Settings: health/probeIntervalSeconds (15), health/hangThresholdMs (2000),
+// health/probeTimeoutMs (10000).
+class PageHealthMonitor : public QObject
+{
+    Q_OBJECT
+
+public:
+    // bucket i holds latencies below 2^i ms, the last one everything slower
+    static const int BucketCount = 14;
+
+    explicit PageHealthMonitor(QWebEngineView *view, QObject *parent = nullptr);
+
+    bool isResponsive() const;
+    qint64 lastLatencyMs() const;
+    int timeouts() const;
+    // probe counts per bucket, over the rolling window
+    QVector<int> histogram() const;
+    // upper bound in ms of the bucket holding the given percentile (0-100)
+    qint64 percentileMs(double percentile) const;
+    QString statsText() const;
+
+public slots:
+    void reloadSettings();
+    // a new page was loaded, forget pending probes
+    void reset();
+    void pageLoaded(bool ok);
+    void setPaused(bool paused);
+    void probe();
+
+signals:
+    void probed(qint64 latencyMs);
+    void responsivenessChanged(bool responsive);
+
+private:
+    void probeTimedOut();
+    void record(qint64 latencyMs);
+    void setResponsive(bool responsive);
+    void updateTimer();
+
+    QWebEngineView *m_view;
+    QSettings settings;
+
+    QTimer m_probeTimer;
+    QTimer m_timeoutTimer;
+    QElapsedTimer m_sinceProbe;
+
+    int m_hangThresholdMs = 2000;
+    quint64 m_sequence = 0;
+    quint64 m_pending = 0;
+    bool m_loaded = false;
+    bool m_paused = false;
+    bool m_responsive = true;
+    qint64 m_lastLatencyMs = -1;
+    int m_timeouts = 0;
+
+    QVector<quint8> m_window;   // ring buffer of bucket indexes
+    int m_windowPos = 0;
+    int m_counts[BucketCount] = {};
+};
+
+#endif // PAGEHEALTHMONITOR_H
@@ -0,0 +1,193 @@
+#include "pagelifecyclemanager.h"
+
+#include <QDebug>
+#include <QWebEnginePage>
+#include <QWebEngineView>
+
+namespace
+{
+    // how long a peek keeps the page running, a discarded page needs to load first
+    const int peekFrozenMs    = 20 * 1000;
+    const int peekDiscardedMs = 60 * 1000;
+
+    // a timer with interval 0 would fire right away, 0 means "off" here
+    void restartIfEnabled(QTimer &timer)
+    {
+        if (timer.interval() > 0)
+            timer.start();
+        else
+            timer.stop();
+    }
+
+    QString formatDuration(qint64 msecs)
+    {
+        qint64 mins = msecs / 60000;
+        if (mins < 60)
+            return QString::number(mins) + "m";
+        return QString::number(mins / 60) + "h " + QString::number(mins % 60) + "m";
+    }
+}
+
+PageLifecycleManager::PageLifecycleManager(QWebEngineView *view, QObject *parent)
+    : QObject(parent),
+      m_view(view)
+{
+    m_freezeTimer.setSingleShot(true);
+    m_discardTimer.setSingleShot(true);
+    m_peekEndTimer.setSingleShot(true);
+
+    connect(&m_freezeTimer, &QTimer::timeout, this, &PageLifecycleManager::freeze);
+    connect(&m_discardTimer, &QTimer::timeout, this, &PageLifecycleManager::discard);
+    connect(&m_peekTimer, &QTimer::timeout, this, &PageLifecycleManager::peek);
+    connect(&m_peekEndTimer, &QTimer::timeout, this, &PageLifecycleManager::endPeek);
+
+    m_sinceTransition.start();
+    reloadSettings();
+}
+
+PageLifecycleManager::State PageLifecycleManager::state() const
+{
+    return m_state;
+}
+
+qint64 PageLifecycleManager::timeInState(State state) const
+{
+    qint64 total = m_timeInState[state];
+    if (state == m_state)
+        total += m_sinceTransition.elapsed();
+    return total;
+}
+
+QString PageLifecycleManager::statsText() const
+{
+    return tr("Page time active: %1, frozen: %2, discarded: %3")
+            .arg(formatDuration(timeInState(Active)))
+            .arg(formatDuration(timeInState(Frozen)))
+            .arg(formatDuration(timeInState(Discarded)));
+}
+
+void PageLifecycleManager::reloadSettings()
+{
+    int freezeAfter  = settings.value("lifecycle/freezeAfterMinutes",10).toInt();
+    int discardAfter = settings.value("lifecycle/discardAfterMinutes",0).toInt();
+    int peekInterval = settings.value("lifecycle/peekIntervalMinutes",5).toInt();
+    // every peek at a discarded page is a full load, so far less often
+    int discardedPeekInterval = settings.value("lifecycle/discardedPeekIntervalMinutes",30).toInt();
+
+    m_freezeTimer.setInterval(freezeAfter * 60000);
+    m_discardTimer.setInterval(discardAfter * 60000);
+    m_peekIntervalMs = peekInterval * 60000;
+    m_discardedPeekIntervalMs = discardedPeekInterval * 60000;
+    m_peekTimer.setInterval(m_state == Discarded ? m_discardedPeekIntervalMs : m_peekIntervalMs);
+
+    // a window that is already hidden only gets the new intervals, the
+    // page keeps its state instead of being thawed or reloaded
+    if (!m_hidden)
+        return;
+    if (m_state == Active && !m_peeking)
+        restartIfEnabled(m_freezeTimer);
+    if (m_state != Discarded)
+        restartIfEnabled(m_discardTimer);
+    if (m_state != Active)
+        restartIfEnabled(m_peekTimer);
+}
+
+void PageLifecycleManager::windowHidden()
+{
+    m_hidden = true;
+    if (m_freezeTimer.interval() > 0)
+        m_freezeTimer.start();
+    if (m_discardTimer.interval() > 0)
+        m_discardTimer.start();
+}
+
+void PageLifecycleManager::windowShown()
+{
+    m_hidden = false;
+    m_peeking = false;
+    m_freezeTimer.stop();
+    m_discardTimer.stop();
+    m_peekTimer.stop();
+    m_peekEndTimer.stop();
+    setState(Active);
+}
+
+bool PageLifecycleManager::canLeaveActive() const
+{
+    // chromium refuses to freeze or discard a visible page
+    return m_hidden && m_view && m_view->page() && !m_view->isVisible();
+}
+
+void PageLifecycleManager::freeze()
+{
+    if (!canLeaveActive() || m_state == Discarded)
+        return;
+    setState(Frozen);
+    m_peekTimer.setInterval(m_peekIntervalMs);
+    restartIfEnabled(m_peekTimer);
+}
+
+void PageLifecycleManager::discard()
+{
+    if (!canLeaveActive())
+        return;
+    m_peeking = false;
+    m_peekEndTimer.stop();
+    setState(Discarded);
+    // the unread count still has to reach the tray, at a slower pace
+    m_peekTimer.setInterval(m_discardedPeekIntervalMs);
+    restartIfEnabled(m_peekTimer);
+}
+
+// thaw the page for a moment so title (unread count) updates reach the tray
+void PageLifecycleManager::peek()
+{
+    if (!m_hidden || m_peeking || m_state == Active)
+        return;
+    m_peeking = true;
+    m_restingState = m_state;
+    m_peekEndTimer.start(m_state == Discarded ? peekDiscardedMs : peekFrozenMs);
+    setState(Active);
+}
+
+void PageLifecycleManager::endPeek()
+{
+    if (!m_peeking)
+        return;
+    m_peeking = false;
+    if (!canLeaveActive())
+        return;
+    // the reloaded page is frozen, not discarded, so it can be peeked at
+    // cheaply until the discard timer drops it again
+    setState(Frozen);
+    if (m_restingState == Discarded) {
+        m_peekTimer.setInterval(m_peekIntervalMs);
+        restartIfEnabled(m_peekTimer);
+        restartIfEnabled(m_discardTimer);
+    }
+}
+
+void PageLifecycleManager::setState(State state)
+{
+    if (state == m_state)
+        return;
+
+#if QT_VERSION >= QT_VERSION_CHECK(5, 14, 0)
+    if (m_view && m_view->page()) {
+        QWebEnginePage::LifecycleState lifecycleState = QWebEnginePage::LifecycleState::Active;
+        if (state == Frozen)
+            lifecycleState = QWebEnginePage::LifecycleState::Frozen;
+        else if (state == Discarded)
+            lifecycleState = QWebEnginePage::LifecycleState::Discarded;
+        m_view->page()->setLifecycleState(lifecycleState);
+    }
+#else
+    if (state != Active)
+        return;
+#endif
+
+    m_timeInState[m_state] += m_sinceTransition.restart();
+    m_state = state;
+    qDebug() << "Page lifecycle state" << state;
+    emit stateChanged(state);
+}
@@ -0,0 +1,74 @@
+#ifndef PAGELIFECYCLEMANAGER_H
+#define PAGELIFECYCLEMANAGER_H
+
+#include <QObject>
+#include <QElapsedTimer>
+#include <QSettings>
+#include <QTimer>
+
+QT_BEGIN_NAMESPACE
+class QWebEngineView;
+QT_END_NAMESPACE
+
+// Freezes and optionally discards the page while the window is hidden to tray.
+// A frozen page is thawed for a short "peek" from time to time so the title,
+// and with it the unread count in the tray, stays current. A discarded page
+// is peeked at too, but every peek reloads it, so only every
+// lifecycle/discardedPeekIntervalMinutes (30); it is frozen afterwards and
+// discarded again later. The page is restored as soon as the window is
+// shown again.
+// Needs Qt 5.14 (QWebEnginePage::LifecycleState), inert on older versions.
+class PageLifecycleManager : public QObject
+{
+    Q_OBJECT
+
+public:
+    enum State { Active = 0, Frozen, Discarded, StateCount };
+    Q_ENUM(State)
+
+    explicit PageLifecycleManager(QWebEngineView *view, QObject *parent = nullptr);
+
+    State state() const;
+    // Total milliseconds the page spent in state, including the current stretch.
+    qint64 timeInState(State state) const;
+    QString statsText() const;
+
+public slots:
+    void reloadSettings();
+    void windowHidden();
+    void windowShown();
+
+signals:
+    void stateChanged(PageLifecycleManager::State state);
+
+private slots:
+    void freeze();
+    void discard();
+    void peek();
+    void endPeek();
+
+private:
+    void setState(State state);
+    bool canLeaveActive() const;
+
+    QWebEngineView *m_view;
+    QSettings settings;
+
+    QTimer m_freezeTimer;
+    QTimer m_discardTimer;
+    QTimer m_peekTimer;
+    QTimer m_peekEndTimer;
+
+    State m_state = Active;
+    // what a peek returns to
+    State m_restingState = Active;
+    int m_peekIntervalMs = 0;
+    int m_discardedPeekIntervalMs = 0;
+    bool m_hidden = false;
+    bool m_peeking = false;
+
+    QElapsedTimer m_sinceTransition;
+    qint64 m_timeInState[StateCount] = {0, 0, 0};
+};
+
+#endif // PAGELIFECYCLEMANAGER_H
@@ -0,0 +1,94 @@
+#include "pagestatebridge.h"
+
+#include "pagebridge.h"
+
+#include <QDebug>
+
+PageStateBridge::PageStateBridge(PageBridge *bridge, QObject *parent)
+    : QObject(parent)
+{
+    bridge->addScript(":/scripts/pagestate.js");
+    bridge->on<QVariantMap>("state", [=](const QVariantMap &state) {
+        update(state);
+    });
+    connect(bridge, &PageBridge::connected, this, &PageStateBridge::reset);
+}
+
+void PageStateBridge::reset()
+{
+    m_hasState = false;
+    m_chatListShown = false;
+}
+
+bool PageStateBridge::hasState() const
+{
+    return m_hasState;
+}
+
+int PageStateBridge::totalUnread() const
+{
+    return m_totalUnread;
+}
+
+QVariantMap PageStateBridge::chatUnread() const
+{
+    return m_chatUnread;
+}
+
+QString PageStateBridge::connectionState() const
+{
+    return m_connection;
+}
+
+QString PageStateBridge::theme() const
+{
+    return m_theme;
+}
+
+QString PageStateBridge::activeChat() const
+{
+    return m_activeChat;
+}
+
+void PageStateBridge::update(const QVariantMap &state)
+{
+    const bool first = !m_hasState;
+    m_hasState = true;
+
+    const int totalUnread = state.value("totalUnread").toInt();
+    if (first || totalUnread != m_totalUnread) {
+        m_totalUnread = totalUnread;
+        emit unreadChanged(totalUnread);
+    }
+
+    const QVariantMap chatUnread = state.value("chats").toMap();
+    if (first || chatUnread != m_chatUnread) {
+        m_chatUnread = chatUnread;
+        emit chatUnreadChanged(chatUnread);
+    }
+
+    const QString connection = state.value("connection").toString();
+    if (connection != m_connection) {
+        m_connection = connection;
+        qDebug() << "Page connection state" << connection;
+        emit connectionStateChanged(connection);
+    }
+
+    const QString theme = state.value("theme").toString();
+    if (theme != m_theme) {
+        m_theme = theme;
+        emit themeChanged(theme);
+    }
+
+    const QString activeChat = state.value("activeChat").toString();
+    if (activeChat != m_activeChat) {
+        m_activeChat = activeChat;
+        emit activeChatChanged(activeChat);
+    }
+
+    const int rows = state.value("chatListRows").toInt();
+    if (!m_chatListShown && rows > 0) {
+        m_chatListShown = true;
+        emit chatListShown(rows);
+    }
+}
@@ -0,0 +1,53 @@
+#ifndef PAGESTATEBRIDGE_H
+#define PAGESTATEBRIDGE_H
+
+#include <QObject>
+#include <QVariantMap>
+
+class PageBridge;
+
+// Receives page state pushed by scripts/pagestate.js, a MutationObserver
+// running on top of PageBridge, as "state" messages. Replaces scraping
+// the window title and one-off runJavaScript calls: C++ only reacts to the
+// change signals below.
+class PageStateBridge : public QObject
+{
+    Q_OBJECT
+
+public:
+    // Adds the observer script to bridge, so construct before the first attach().
+    explicit PageStateBridge(PageBridge *bridge, QObject *parent = nullptr);
+
+    // true once the page pushed its first state
+    bool hasState() const;
+    int totalUnread() const;
+    QVariantMap chatUnread() const;
+    QString connectionState() const;
+    QString theme() const;
+    QString activeChat() const;
+
+public slots:
+    void update(const QVariantMap &state);
+    // a new document connected, its first state is reported in full
+    void reset();
+
+signals:
+    void unreadChanged(int totalUnread);
+    void chatUnreadChanged(const QVariantMap &chatUnread);
+    void connectionStateChanged(const QString &state);
+    void themeChanged(const QString &theme);
+    void activeChatChanged(const QString &chat);
+    // first time the chat list has rows after attach()
+    void chatListShown(int rows);
+
+private:
+    bool m_hasState = false;
+    bool m_chatListShown = false;
+    int m_totalUnread = 0;
+    QVariantMap m_chatUnread;
+    QString m_connection;
+    QString m_theme;
+    QString m_activeChat;
+};
+
+#endif // PAGESTATEBRIDGE_H
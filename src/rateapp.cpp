@@ -23,24 +23,13 @@ RateApp::RateApp(QWidget *parent, QString app_rating_url, int app_launch_count,
           showTimer->stop();
     });
 
-    //increase the app_launched_count by one
-    int app_launched  = settings.value("app_launched_count",0).toInt();
-    settings.setValue("app_launched_count",app_launched + 1);
-
-    //check if app install time is set in settings
-    if(settings.value("app_install_time").isNull())
-    {
-        settings.setValue("app_install_time",QDateTime::currentSecsSinceEpoch());
-
-    }else if (settings.value("app_install_time").isValid())
-    {
-        qDebug()<<"RATEAPP should show:"<<shouldShow();
-        if(shouldShow()){
-            showTimer->start();
-        }else {
-            //if shouldshow is false, delete this obj to free resources
-            this->deleteLater();
-        }
+    //launch bookkeeping is done by registerLaunch()
+    qDebug()<<"RATEAPP should show:"<<shouldShow();
+    if(shouldShow()){
+        showTimer->start();
+    }else {
+        //if shouldshow is false, delete this obj to free resources
+        this->deleteLater();
     }
 
     //if already reated delete this obj to free resources
@@ -62,11 +51,30 @@ void RateApp::delayShowEvent()
 }
 
 /**
- * @brief RateApp::shouldShow
- * @return true, if the dialog should be shown to user
+ * @brief RateApp::registerLaunch counts this launch, cheap enough to run on every
+ * startup without constructing the dialog
+ * @return true, if the dialog is due and RateApp should be constructed
  */
-bool RateApp::shouldShow()
+bool RateApp::registerLaunch(int app_launch_count, int app_install_days)
+{
+    QSettings settings;
+
+    //increase the app_launched_count by one
+    int app_launched  = settings.value("app_launched_count",0).toInt();
+    settings.setValue("app_launched_count",app_launched + 1);
+
+    //check if app install time is set in settings
+    if(settings.value("app_install_time").isNull())
+    {
+        settings.setValue("app_install_time",QDateTime::currentSecsSinceEpoch());
+        return false;
+    }
+    return isDue(app_launch_count, app_install_days);
+}
+
+bool RateApp::isDue(int app_launch_count, int app_install_days)
 {
+    QSettings settings;
     bool shouldShow = false;
     int app_launched_count      = settings.value("app_launched_count",0).toInt();
     qint64 currentDateTime      = QDateTime::currentSecsSinceEpoch();
@@ -77,12 +85,21 @@ bool RateApp::shouldShow()
         return false;
 
     shouldShow = (((currentDateTime - installed_date_time > app_install_days * 86400) ||
-                   app_launched_count >= this->app_launch_count)
+                   app_launched_count >= app_launch_count)
             && ratedAlready == false);
 
     return shouldShow;
 }
 
+/**
+ * @brief RateApp::shouldShow
+ * @return true, if the dialog should be shown to user
+ */
+bool RateApp::shouldShow()
+{
+    return isDue(this->app_launch_count, this->app_install_days);
+}
+
 RateApp::~RateApp()
 {
     qDebug()<<"RateApp Obj deleted";
@@ -24,6 +24,9 @@ public:
                      int app_launch_count = 5, int app_install_days = 5, int present_delay = 5000);
     ~RateApp();
 
+    static bool registerLaunch(int app_launch_count, int app_install_days);
+    static bool isDue(int app_launch_count, int app_install_days);
+
 public slots:
     void delayShowEvent();
 
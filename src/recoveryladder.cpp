@@ -0,0 +1,196 @@
+#include "recoveryladder.h"
+
+#include <QDateTime>
+#include <QDebug>
+#include <QWebEngineHttpRequest>
+#include <QWebEnginePage>
+#include <QWebEngineProfile>
+#include <QWebEngineScript>
+#include <QWebEngineView>
+
+#include "webenginepage.h"
+
+namespace
+{
+    // a tier without a verdict within this time is run again
+    const int verdictTimeoutMs = 90 * 1000;
+    const int keptHistoryEntries = 50;
+
+    const char *unregisterServiceWorkers =
+            "Promise.all(["
+            "  navigator.serviceWorker ? navigator.serviceWorker.getRegistrations()"
+            "    .then(function(rs){ return Promise.all(rs.map(function(r){ return r.unregister(); })); }) : 0,"
+            "  window.caches ? caches.keys()"
+            "    .then(function(ks){ return Promise.all(ks.map(function(k){ return caches.delete(k); })); }) : 0"
+            "]).then(function(){ location.reload(); }, function(){ location.reload(); });";
+}
+
+RecoveryLadder::RecoveryLadder(QWebEngineView *view, QObject *parent)
+    : QObject(parent),
+      m_view(view)
+{
+    m_verdictTimer.setSingleShot(true);
+    m_verdictTimer.setInterval(verdictTimeoutMs);
+    connect(&m_verdictTimer, &QTimer::timeout, this, &RecoveryLadder::verdictTimedOut);
+
+    // an attempt that restarted the app (storage wipe) is judged by this run
+    m_attempt = settings.value("recovery/pendingTier", -1).toInt();
+    m_reason = settings.value("recovery/pendingReason").toString();
+    if (m_attempt >= 0)
+        m_verdictTimer.start();
+}
+
+QString RecoveryLadder::tierName(Tier tier)
+{
+    switch (tier) {
+    case SoftReload:          return QStringLiteral("softReload");
+    case BypassCacheReload:   return QStringLiteral("bypassCacheReload");
+    case ClearHttpCache:      return QStringLiteral("clearHttpCache");
+    case ClearServiceWorkers: return QStringLiteral("clearServiceWorkers");
+    case WipeStorage:         return QStringLiteral("wipeStorage");
+    case TierCount:           break;
+    }
+    return QString();
+}
+
+bool RecoveryLadder::isRecovering() const
+{
+    return m_attempt >= 0;
+}
+
+QString RecoveryLadder::statsText() const
+{
+    QStringList lines;
+    for (int tier = 0; tier < TierCount; ++tier) {
+        const QString key = "recovery/stats/" + tierName(Tier(tier));
+        lines.append(tr("%1: fixed %2, failed %3")
+                     .arg(tierName(Tier(tier)))
+                     .arg(settings.value(key + "/fixed", 0).toInt())
+                     .arg(settings.value(key + "/failed", 0).toInt()));
+    }
+    return lines.join("\n");
+}
+
+void RecoveryLadder::escalate(const QString &reason)
+{
+    int next = 0;
+    if (m_attempt >= 0) {
+        next = m_attempt + 1;
+        finishAttempt(false);
+    }
+    m_reason = reason;
+
+    if (next >= TierCount) {
+        qWarning() << "Recovery ladder exhausted," << reason;
+        emit exhausted(reason);
+        return;
+    }
+    run(Tier(next));
+}
+
+void RecoveryLadder::setResponsive(bool responsive)
+{
+    m_responsive = responsive;
+    // a hung renderer is not a broken page, a reload is all it gets; the
+    // load that follows tells whether it is broken
+    if (responsive == false && m_attempt < 0) {
+        m_reason = QStringLiteral("unresponsive");
+        run(SoftReload);
+    }
+}
+
+void RecoveryLadder::pageHealthy()
+{
+    if (m_attempt >= 0)
+        finishAttempt(true);
+}
+
+void RecoveryLadder::storageWipeDeclined()
+{
+    if (m_attempt == WipeStorage)
+        finishAttempt(false);
+}
+
+void RecoveryLadder::verdictTimedOut()
+{
+    // no verdict is not a failure, the page may just be offline
+    qWarning() << "Recovery ladder: no verdict for" << tierName(Tier(m_attempt)) << ", running it again";
+    if (m_attempt == WipeStorage) {
+        // never wipe twice without a detection in between
+        m_verdictTimer.start();
+        return;
+    }
+    run(Tier(m_attempt));
+}
+
+void RecoveryLadder::run(Tier tier)
+{
+    m_attempt = tier;
+    settings.setValue("recovery/pendingTier", m_attempt);
+    settings.setValue("recovery/pendingReason", m_reason);
+    m_verdictTimer.start();
+
+    qWarning() << "Recovery ladder:" << tierName(tier) << "because of" << m_reason;
+
+    QWebEnginePage *page = m_view ? m_view->page() : nullptr;
+    if (page == nullptr)
+        return;
+
+    switch (tier) {
+    case SoftReload:
+        page->triggerAction(QWebEnginePage::Reload);
+        break;
+    case BypassCacheReload: {
+        // a stale shell, fetch the page under a url the caches have not seen
+        QWebEngineHttpRequest request(WebEnginePage::cacheBustedHomeUrl());
+        request.setHeader("Cache-Control", "no-cache");
+        request.setHeader("Pragma", "no-cache");
+        page->load(request);
+        break;
+    }
+    case ClearHttpCache:
+        page->profile()->clearHttpCache();
+        page->triggerAction(QWebEnginePage::ReloadAndBypassCache);
+        break;
+    case ClearServiceWorkers:
+        if (m_responsive == false) {
+            // the script would only queue up behind the hang, a reload
+            // bypassing the cache is the next best thing
+            page->triggerAction(QWebEnginePage::ReloadAndBypassCache);
+            break;
+        }
+        // the page reloads itself once the workers and their caches are gone
+        page->runJavaScript(unregisterServiceWorkers, QWebEngineScript::ApplicationWorld);
+        break;
+    case WipeStorage:
+        emit storageWipeRequested();
+        break;
+    case TierCount:
+        break;
+    }
+}
+
+void RecoveryLadder::finishAttempt(bool fixed)
+{
+    m_verdictTimer.stop();
+    const Tier tier = Tier(m_attempt);
+    m_attempt = -1;
+    settings.remove("recovery/pendingTier");
+    settings.remove("recovery/pendingReason");
+
+    const QString counter = "recovery/stats/" + tierName(tier) + (fixed ? "/fixed" : "/failed");
+    settings.setValue(counter, settings.value(counter, 0).toInt() + 1);
+
+    // entries are "<ISO time> <tier> <fixed|failed> <reason>"
+    QStringList history = settings.value("recovery/history").toStringList();
+    history.append(QString("%1 %2 %3 %4")
+                   .arg(QDateTime::currentDateTimeUtc().toString(Qt::ISODate))
+                   .arg(tierName(tier))
+                   .arg(fixed ? "fixed" : "failed")
+                   .arg(m_reason));
+    while (history.size() > keptHistoryEntries)
+        history.removeFirst();
+    settings.setValue("recovery/history", history);
+
+    qWarning() << "Recovery ladder:" << tierName(tier) << (fixed ? "fixed the page" : "did not help");
+}
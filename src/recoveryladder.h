@@ -0,0 +1,72 @@
+#ifndef RECOVERYLADDER_H
+#define RECOVERYLADDER_H
+
+#include <QObject>
+#include <QSettings>
+#include <QTimer>
+
+QT_BEGIN_NAMESPACE
+class QWebEngineView;
+QT_END_NAMESPACE
+
+// Escalating recovery for a page that did not load correctly or hangs.
+// Every escalate() tries the next tier, cheapest first:
+//
+//   soft reload < cache-busted load of the home url < clear the HTTP cache
+//   < unregister service workers < wipe storage (logs the user out)
+//
+// Only a positive detection of a broken page escalates. A page that stopped
+// responding just gets a soft reload, and a tier without a verdict (offline,
+// failed load) is run again instead of counting as failed. The storage wipe
+// is only requested, the app asks the user before doing it.
+//
+// The next healthy load confirms the tier that fixed it and the ladder
+// starts over at the bottom. The attempt in flight is persisted, so a
+// verdict is also recorded for the storage wipe, which restarts the app.
+// Outcomes go to recovery/history and per tier counters under recovery/stats.
+class RecoveryLadder : public QObject
+{
+    Q_OBJECT
+
+public:
+    enum Tier { SoftReload = 0, BypassCacheReload, ClearHttpCache, ClearServiceWorkers,
+                WipeStorage, TierCount };
+    Q_ENUM(Tier)
+
+    explicit RecoveryLadder(QWebEngineView *view, QObject *parent = nullptr);
+
+    static QString tierName(Tier tier);
+    bool isRecovering() const;
+    QString statsText() const;
+
+public slots:
+    // the page was detected broken, try the next tier
+    void escalate(const QString &reason);
+    // the page stopped or started responding again
+    void setResponsive(bool responsive);
+    // the page loaded correctly
+    void pageHealthy();
+    // the user refused the storage wipe, give up on this attempt
+    void storageWipeDeclined();
+
+signals:
+    // the app should wipe the profile storage and restart, once the user agrees
+    void storageWipeRequested();
+    // every tier failed
+    void exhausted(const QString &reason);
+
+private:
+    void run(Tier tier);
+    void finishAttempt(bool fixed);
+    void verdictTimedOut();
+
+    QWebEngineView *m_view;
+    QSettings settings;
+    QTimer m_verdictTimer;
+
+    int m_attempt = -1;         // tier awaiting its verdict, -1 if none
+    QString m_reason;
+    bool m_responsive = true;
+};
+
+#endif // RECOVERYLADDER_H
@@ -0,0 +1,327 @@
+#include "resourcemonitor.h"
+
+#include <QApplication>
+#include <QDir>
+#include <QElapsedTimer>
+#include <QFile>
+#include <QFileInfo>
+#include <QHeaderView>
+#include <QLabel>
+#include <QTableWidget>
+#include <QVBoxLayout>
+
+#ifdef Q_OS_LINUX
+#include <unistd.h>
+#endif
+
+namespace
+{
+    QString withUnit(qint64 bytes)
+    {
+        if (bytes < 0)
+            return QStringLiteral("-");
+        if (bytes < (1 << 20))
+            return QString::number(bytes / double(1 << 10), 'f', 1) + " KiB";
+        if (bytes < (1 << 30))
+            return QString::number(bytes / double(1 << 20), 'f', 1) + " MiB";
+        return QString::number(bytes / double(1 << 30), 'f', 2) + " GiB";
+    }
+
+#ifdef Q_OS_LINUX
+    QByteArray readProcFile(qint64 pid, const char *name)
+    {
+        QFile file(QString("/proc/%1/%2").arg(pid).arg(QLatin1String(name)));
+        if (!file.open(QIODevice::ReadOnly))
+            return QByteArray();
+        return file.readAll();
+    }
+
+    struct StatLine
+    {
+        bool valid = false;
+        QString name;
+        qint64 parentPid = 0;
+        qint64 ticks = 0;
+    };
+
+    // /proc/<pid>/stat: "pid (comm) state ppid ... utime stime ..."
+    StatLine parseStat(const QByteArray &stat)
+    {
+        StatLine line;
+        int open = stat.indexOf('(');
+        int close = stat.lastIndexOf(')');
+        if (open == -1 || close == -1)
+            return line;
+        line.name = QString::fromLocal8Bit(stat.mid(open + 1, close - open - 1));
+
+        // fields after comm, starting with state (field 3)
+        const QList<QByteArray> fields = stat.mid(close + 2).split(' ');
+        if (fields.size() < 13)
+            return line;
+        line.parentPid = fields.at(1).toLongLong();
+        line.ticks = fields.at(11).toLongLong() + fields.at(12).toLongLong();
+        line.valid = true;
+        return line;
+    }
+
+    // Children of every thread of pid (/proc/<pid>/task/<tid>/children, needs
+    // CONFIG_PROC_CHILDREN). ok is false when the kernel does not provide it.
+    QVector<qint64> childPids(qint64 pid, bool *ok)
+    {
+        QVector<qint64> pids;
+        const QDir tasks(QString("/proc/%1/task").arg(pid));
+        *ok = true;
+        for (const QString &task : tasks.entryList(QDir::Dirs | QDir::NoDotAndDotDot)) {
+            QFile file(tasks.filePath(task + "/children"));
+            if (!file.open(QIODevice::ReadOnly)) {
+                // a thread that just exited, or no children files at all
+                if (!QFileInfo::exists(tasks.filePath(task)))
+                    continue;
+                *ok = false;
+                return pids;
+            }
+            for (const QByteArray &child : file.readAll().split(' ')) {
+                const qint64 childPid = child.trimmed().toLongLong();
+                if (childPid > 0)
+                    pids.append(childPid);
+            }
+        }
+        return pids;
+    }
+
+    // the fallback without children files: one pass over every process on the host
+    QMultiHash<qint64, qint64> scanProcessTree()
+    {
+        QMultiHash<qint64, qint64> children;
+        const QStringList entries = QDir("/proc").entryList(QDir::Dirs | QDir::NoDotAndDotDot);
+        for (const QString &entry : entries) {
+            bool isPid = false;
+            qint64 pid = entry.toLongLong(&isPid);
+            if (!isPid)
+                continue;
+            StatLine stat = parseStat(readProcFile(pid, "stat"));
+            if (stat.valid)
+                children.insert(stat.parentPid, pid);
+        }
+        return children;
+    }
+
+    QString processType(const QByteArray &cmdline)
+    {
+        for (const QByteArray &arg : cmdline.split('\0')) {
+            if (arg.startsWith("--type="))
+                return QString::fromLatin1(arg.mid(7));
+        }
+        return QString();
+    }
+
+    qint64 pssBytes(qint64 pid)
+    {
+        const QByteArray rollup = readProcFile(pid, "smaps_rollup");
+        for (const QByteArray &line : rollup.split('\n')) {
+            if (line.startsWith("Pss:"))
+                return line.mid(4).trimmed().split(' ').first().toLongLong() * 1024;
+        }
+        return -1;
+    }
+#endif
+}
+
+ResourceSampler::ResourceSampler(qint64 rootPid, QObject *parent)
+    : QObject(parent),
+      m_rootPid(rootPid)
+{
+}
+
+void ResourceSampler::start(int intervalMs)
+{
+    if (m_timer == nullptr) {
+        m_timer = new QTimer(this);
+        connect(m_timer, &QTimer::timeout, this, &ResourceSampler::sample);
+    }
+    m_timer->start(intervalMs);
+    sample();
+}
+
+void ResourceSampler::stop()
+{
+    if (m_timer)
+        m_timer->stop();
+    m_previous.clear();
+}
+
+void ResourceSampler::sample()
+{
+    QVector<ProcessSample> samples;
+
+#ifdef Q_OS_LINUX
+    static QElapsedTimer wallClock;
+    if (!wallClock.isValid())
+        wallClock.start();
+    const qint64 nowMs = wallClock.elapsed();
+    const long ticksPerSecond = sysconf(_SC_CLK_TCK);
+    const long pageSize = sysconf(_SC_PAGESIZE);
+
+    // walk down from the browser process, the rest of the host is never read;
+    // terminal servers run hundreds of processes
+    bool haveChildFiles = true;
+    QMultiHash<qint64, qint64> scanned;
+    bool treeScanned = false;
+
+    QHash<qint64, CpuTimes> current;
+    QVector<qint64> queue;
+    queue.append(m_rootPid);
+    for (int i = 0; i < queue.size(); ++i) {
+        const qint64 pid = queue.at(i);
+        if (haveChildFiles) {
+            const QVector<qint64> children = childPids(pid, &haveChildFiles);
+            if (haveChildFiles)
+                queue.append(children);
+        }
+        if (!haveChildFiles) {
+            if (!treeScanned) {
+                treeScanned = true;
+                scanned = scanProcessTree();
+            }
+            queue.append(scanned.values(pid).toVector());
+        }
+
+        const StatLine stat = parseStat(readProcFile(pid, "stat"));
+        if (!stat.valid)
+            continue;
+
+        ProcessSample sample;
+        sample.pid = pid;
+        sample.parentPid = stat.parentPid;
+        sample.name = stat.name;
+        sample.type = pid == m_rootPid ? QString("browser") : processType(readProcFile(pid, "cmdline"));
+
+        const QList<QByteArray> statm = readProcFile(pid, "statm").split(' ');
+        if (statm.size() > 1)
+            sample.rssBytes = statm.at(1).toLongLong() * pageSize;
+        sample.pssBytes = pssBytes(pid);
+
+        CpuTimes times;
+        times.ticks = stat.ticks;
+        times.wallMs = nowMs;
+        current.insert(pid, times);
+        if (m_previous.contains(pid)) {
+            const CpuTimes &previous = m_previous[pid];
+            const qint64 wallDelta = times.wallMs - previous.wallMs;
+            if (wallDelta > 0 && ticksPerSecond > 0) {
+                const double cpuMs = (times.ticks - previous.ticks) * 1000.0 / ticksPerSecond;
+                sample.cpuPercent = 100.0 * cpuMs / wallDelta;
+            }
+        }
+        samples.append(sample);
+    }
+    m_previous = current;
+#endif
+
+    emit sampled(samples);
+}
+
+ResourceMonitorWidget::ResourceMonitorWidget(QWidget *parent)
+    : QWidget(parent)
+{
+    qRegisterMetaType<ProcessSample>();
+    qRegisterMetaType<QVector<ProcessSample>>();
+
+    setWindowTitle(QApplication::applicationName()+" | "+tr("Resource monitor"));
+    setMinimumSize(560, 300);
+
+    m_table = new QTableWidget(0, 6, this);
+    m_table->setHorizontalHeaderLabels(QStringList() << tr("PID") << tr("Process") << tr("Type")
+                                       << tr("CPU") << tr("RSS") << tr("PSS"));
+    m_table->verticalHeader()->hide();
+    m_table->horizontalHeader()->setSectionResizeMode(QHeaderView::ResizeToContents);
+    m_table->horizontalHeader()->setStretchLastSection(true);
+    m_table->setEditTriggers(QAbstractItemView::NoEditTriggers);
+    m_table->setSelectionMode(QAbstractItemView::NoSelection);
+
+    m_totals = new QLabel(this);
+    m_extraInfo = new QLabel(this);
+    m_extraInfo->setWordWrap(true);
+    m_extraInfo->hide();
+
+    QVBoxLayout *layout = new QVBoxLayout(this);
+    layout->addWidget(m_table);
+    layout->addWidget(m_totals);
+    layout->addWidget(m_extraInfo);
+
+#ifndef Q_OS_LINUX
+    m_totals->setText(tr("Process statistics are only available on Linux."));
+#endif
+
+    m_sampler = new ResourceSampler(QApplication::applicationPid());
+    m_sampler->moveToThread(&m_thread);
+    connect(&m_thread, &QThread::finished, m_sampler, &QObject::deleteLater);
+    connect(m_sampler, &ResourceSampler::sampled, this, &ResourceMonitorWidget::updateSamples);
+    m_thread.setObjectName("ResourceSampler");
+    m_thread.start(QThread::LowPriority);
+}
+
+ResourceMonitorWidget::~ResourceMonitorWidget()
+{
+    m_thread.quit();
+    m_thread.wait();
+}
+
+void ResourceMonitorWidget::setExtraInfo(const QString &html)
+{
+    m_extraInfo->setText(html);
+    m_extraInfo->setVisible(!html.isEmpty());
+}
+
+void ResourceMonitorWidget::showEvent(QShowEvent *event)
+{
+    QWidget::showEvent(event);
+    QMetaObject::invokeMethod(m_sampler, "start", Qt::QueuedConnection, Q_ARG(int, 1000));
+}
+
+void ResourceMonitorWidget::hideEvent(QHideEvent *event)
+{
+    QWidget::hideEvent(event);
+    QMetaObject::invokeMethod(m_sampler, "stop", Qt::QueuedConnection);
+}
+
+void ResourceMonitorWidget::updateSamples(const QVector<ProcessSample> &samples)
+{
+    m_table->setRowCount(samples.size());
+
+    double totalCpu = 0;
+    qint64 totalRss = 0, totalPss = 0, ourPss = 0;
+    for (int row = 0; row < samples.size(); ++row) {
+        const ProcessSample &sample = samples.at(row);
+        const QStringList cells = QStringList()
+                << QString::number(sample.pid)
+                << sample.name
+                << (sample.type.isEmpty() ? QString("-") : sample.type)
+                << QString::number(sample.cpuPercent, 'f', 1) + " %"
+                << withUnit(sample.rssBytes)
+                << withUnit(sample.pssBytes);
+        for (int column = 0; column < cells.size(); ++column) {
+            QTableWidgetItem *item = m_table->item(row, column);
+            if (item == nullptr) {
+                item = new QTableWidgetItem;
+                m_table->setItem(row, column, item);
+            }
+            item->setText(cells.at(column));
+        }
+        totalCpu += sample.cpuPercent;
+        totalRss += sample.rssBytes;
+        totalPss += qMax<qint64>(0, sample.pssBytes);
+        if (sample.type == "browser")
+            ourPss = sample.pssBytes;
+    }
+
+    if (!samples.isEmpty()) {
+        // PSS splits shared pages fairly, so the totals add up to the real footprint
+        m_totals->setText(tr("Total: %1 % CPU, %2 PSS (%3 RSS). Browser process: %4, child processes: %5")
+                          .arg(QString::number(totalCpu, 'f', 1))
+                          .arg(withUnit(totalPss))
+                          .arg(withUnit(totalRss))
+                          .arg(withUnit(ourPss))
+                          .arg(withUnit(totalPss - qMax<qint64>(0, ourPss))));
+    }
+}
@@ -0,0 +1,82 @@
+#ifndef RESOURCEMONITOR_H
+#define RESOURCEMONITOR_H
+
+#include <QHash>
+#include <QMetaType>
+#include <QObject>
+#include <QThread>
+#include <QTimer>
+#include <QVector>
+#include <QWidget>
+
+QT_BEGIN_NAMESPACE
+class QLabel;
+class QTableWidget;
+QT_END_NAMESPACE
+
+struct ProcessSample
+{
+    qint64 pid = 0;
+    qint64 parentPid = 0;
+    QString name;
+    QString type;       // browser, renderer, gpu-process, utility, zygote ...
+    double cpuPercent = 0;
+    qint64 rssBytes = 0;
+    qint64 pssBytes = -1; // -1 when smaps_rollup is not readable
+};
+Q_DECLARE_METATYPE(ProcessSample)
+Q_DECLARE_METATYPE(QVector<ProcessSample>)
+
+// Reads /proc for our process and all its descendants (QtWebEngineProcess
+// children). Lives on a worker thread, GUI thread only receives the results.
+class ResourceSampler : public QObject
+{
+    Q_OBJECT
+
+public:
+    explicit ResourceSampler(qint64 rootPid, QObject *parent = nullptr);
+
+public slots:
+    void start(int intervalMs);
+    void stop();
+    void sample();
+
+signals:
+    void sampled(const QVector<ProcessSample> &samples);
+
+private:
+    struct CpuTimes { qint64 ticks = 0; qint64 wallMs = 0; };
+
+    qint64 m_rootPid;
+    QTimer *m_timer = nullptr;
+    QHash<qint64, CpuTimes> m_previous;
+};
+
+// Diagnostics panel with live CPU and memory use per process.
+class ResourceMonitorWidget : public QWidget
+{
+    Q_OBJECT
+
+public:
+    explicit ResourceMonitorWidget(QWidget *parent = nullptr);
+    ~ResourceMonitorWidget();
+
+    // Extra lines shown under the table, e.g. page health.
+    void setExtraInfo(const QString &html);
+
+protected:
+    void showEvent(QShowEvent *event) override;
+    void hideEvent(QHideEvent *event) override;
+
+private slots:
+    void updateSamples(const QVector<ProcessSample> &samples);
+
+private:
+    QThread m_thread;
+    ResourceSampler *m_sampler;
+    QTableWidget *m_table;
+    QLabel *m_totals;
+    QLabel *m_extraInfo;
+};
+
+#endif // RESOURCEMONITOR_H
@@ -1,6 +1,18 @@
 #include "rungaurd.h"
 
 #include <QCryptographicHash>
+#include <QDataStream>
+#include <QDebug>
+#include <QDir>
+#include <QElapsedTimer>
+#include <QLocalServer>
+#include <QLocalSocket>
+#include <QStandardPaths>
+#include <QThread>
+
+#ifdef Q_OS_UNIX
+#include <unistd.h>
+#endif
 
 namespace
 {
@@ -16,22 +28,57 @@ namespace
         return data;
     }
 
-}
+    const char ackByte = 'A';
+    // a few arguments and links; anything larger is not from our sendMessage()
+    const quint32 maxMessageSize = 64 * 1024;
 
+    // Identifies the user session, so every user of a shared host
+    // (Xrdp/VNC terminal servers) gets an independent guard.
+    QString sessionScope()
+    {
+        QString scope;
+#ifdef Q_OS_UNIX
+        scope = "uid:" + QString::number( ::getuid() );
+#else
+        scope = "user:" + qEnvironmentVariable( "USERNAME" )
+                + ";session:" + qEnvironmentVariable( "SESSIONNAME" );
+#endif
+        scope += ";runtime:" + qEnvironmentVariable( "XDG_RUNTIME_DIR" );
+        return scope;
+    }
 
-RunGuard::RunGuard( const QString& key )
-    : key( key )
-    , memLockKey( generateKeyHash( key, "_memLockKey" ) )
-    , sharedmemKey( generateKeyHash( key, "_sharedmemKey" ) )
-    , sharedMem( sharedmemKey )
-    , memLock( memLockKey, 1 )
-{
-    memLock.acquire();
+    // Per-user directory for the lock and socket files, shared /tmp only as a fallback.
+    QString runtimeDir()
     {
-        QSharedMemory fix( sharedmemKey );    // Fix for *nix: http://habrahabr.ru/post/173281/
-        fix.attach();
+        QString dir = QStandardPaths::writableLocation( QStandardPaths::RuntimeLocation );
+        if ( dir.isEmpty() || !QDir().mkpath( dir ) )
+            dir = QDir::tempPath();
+        return dir;
     }
-    memLock.release();
+
+    QString localServerName( const QString& name )
+    {
+#ifdef Q_OS_UNIX
+        // a full path keeps the socket out of the shared /tmp
+        return runtimeDir() + "/" + name;
+#else
+        // named pipes live in their own per-session namespace
+        return name;
+#endif
+    }
+
+}
+
+
+RunGuard::RunGuard( const QString& key, QObject *parent )
+    : QObject( parent )
+    , key( key )
+    , serverName( localServerName( generateKeyHash( key + sessionScope(), "_instanceServer" ) ) )
+    , lockFilePath( runtimeDir() + "/" + generateKeyHash( key + sessionScope(), "_lockFile" ) + ".lock" )
+    , lockFile( lockFilePath )
+{
+    // never treat a lock as stale by age, only when its owner is gone
+    lockFile.setStaleLockTime( 0 );
 }
 
 RunGuard::~RunGuard()
@@ -41,30 +88,37 @@ RunGuard::~RunGuard()
 
 bool RunGuard::isAnotherRunning()
 {
-    if ( sharedMem.isAttached() )
+    if ( lockFile.isLocked() )
         return false;
 
-    memLock.acquire();
-    const bool isRunning = sharedMem.attach();
+    QLocalSocket socket;
+    socket.connectToServer( serverName );
+    const bool isRunning = socket.waitForConnected( 100 );
     if ( isRunning )
-        sharedMem.detach();
-    memLock.release();
+        socket.disconnectFromServer();
 
     return isRunning;
 }
 
 bool RunGuard::tryToRun()
 {
-    if ( isAnotherRunning() )   // Extra check
+    if ( lockFile.isLocked() )
+        return true;
+
+    // tryLock() removes the lock file if the pid recorded in it is dead
+    if ( !lockFile.tryLock( 0 ) )
         return false;
 
-    memLock.acquire();
-    const bool result = sharedMem.create( sizeof( quint64 ) );
-    memLock.release();
-    if ( !result )
+    // a crashed instance leaves its socket file behind
+    QLocalServer::removeServer( serverName );
+
+    server = new QLocalServer( this );
+    server->setSocketOptions( QLocalServer::UserAccessOption );
+    connect( server, &QLocalServer::newConnection, this, &RunGuard::handleNewConnection );
+    if ( !server->listen( serverName ) )
     {
-        release();
-        return false;
+        // still the only instance, other launches just can't hand over to us
+        qWarning() << "RunGuard: unable to listen on" << serverName << server->errorString();
     }
 
     return true;
@@ -72,8 +126,97 @@ bool RunGuard::tryToRun()
 
 void RunGuard::release()
 {
-    memLock.acquire();
-    if ( sharedMem.isAttached() )
-        sharedMem.detach();
-    memLock.release();
+    if ( server )
+    {
+        server->close();
+        server->deleteLater();
+        server = nullptr;
+    }
+    if ( lockFile.isLocked() )
+        lockFile.unlock();
+}
+
+bool RunGuard::sendMessage( const QStringList& arguments, int timeoutMs )
+{
+    QElapsedTimer timer;
+    timer.start();
+
+    // the running instance may hold the lock but not listen yet, retry until the timeout
+    QLocalSocket socket;
+    forever
+    {
+        socket.connectToServer( serverName );
+        if ( socket.waitForConnected( qMax( 1, timeoutMs - int( timer.elapsed() ) ) ) )
+            break;
+        if ( timer.elapsed() >= timeoutMs )
+        {
+            qWarning() << "RunGuard: running instance not reachable" << socket.errorString();
+            return false;
+        }
+        QThread::msleep( 20 );
+    }
+
+    QByteArray payload;
+    QDataStream out( &payload, QIODevice::WriteOnly );
+    out << arguments;
+
+    QByteArray message;
+    QDataStream header( &message, QIODevice::WriteOnly );
+    header << quint32( payload.size() );
+    message.append( payload );
+
+    socket.write( message );
+    if ( !socket.waitForBytesWritten( qMax( 1, timeoutMs - int( timer.elapsed() ) ) ) )
+        return false;
+
+    if ( !socket.waitForReadyRead( qMax( 1, timeoutMs - int( timer.elapsed() ) ) ) )
+        return false;
+
+    const bool acknowledged = socket.read( 1 ) == QByteArray( 1, ackByte );
+    socket.disconnectFromServer();
+    return acknowledged;
+}
+
+void RunGuard::handleNewConnection()
+{
+    while ( QLocalSocket *socket = server->nextPendingConnection() )
+    {
+        connect( socket, &QLocalSocket::disconnected, socket, &QLocalSocket::deleteLater );
+        connect( socket, &QLocalSocket::readyRead, this, [this, socket]()
+        {
+            readMessage( socket );
+        });
+        if ( socket->bytesAvailable() > 0 )
+            readMessage( socket );
+    }
+}
+
+void RunGuard::readMessage( QLocalSocket *socket )
+{
+    const int headerSize = int( sizeof( quint32 ) );
+    if ( socket->bytesAvailable() < headerSize )
+        return;
+
+    quint32 size = 0;
+    QDataStream header( socket->peek( headerSize ) );
+    header >> size;
+    if ( size > maxMessageSize )
+    {
+        qWarning() << "RunGuard: dropping a message of" << size << "bytes";
+        socket->abort();
+        return;
+    }
+    if ( socket->bytesAvailable() < headerSize + qint64( size ) )
+        return;
+
+    socket->read( headerSize );
+    QDataStream in( socket->read( size ) );
+    QStringList arguments;
+    in >> arguments;
+
+    socket->write( QByteArray( 1, ackByte ) );
+    socket->flush();
+
+    if ( in.status() == QDataStream::Ok )
+        emit messageReceived( arguments );
 }
@@ -2,28 +2,49 @@
 #define RUNGUARD_H
 
 #include <QObject>
-#include <QSharedMemory>
-#include <QSystemSemaphore>
-
-
-class RunGuard
+#include <QLockFile>
+#include <QStringList>
+
+QT_BEGIN_NAMESPACE
+class QLocalServer;
+class QLocalSocket;
+QT_END_NAMESPACE
+
+// Single instance guard.
+// The first instance takes a lock file and listens on a local socket, later
+// instances forward their arguments over that socket and exit. The lock file
+// records the owner's pid so a lock left behind by a crash is taken over.
+// The guard is scoped to the user session (uid + XDG_RUNTIME_DIR), so other
+// users on the same host are not affected.
+class RunGuard : public QObject
 {
+    Q_OBJECT
 
 public:
-    RunGuard( const QString& key );
+    explicit RunGuard( const QString& key, QObject *parent = nullptr );
     ~RunGuard();
 
     bool isAnotherRunning();
     bool tryToRun();
     void release();
 
+    // Sends arguments to the running instance, returns true once it acknowledged them.
+    bool sendMessage( const QStringList& arguments, int timeoutMs = 1000 );
+
+signals:
+    void messageReceived( const QStringList& arguments );
+
+private slots:
+    void handleNewConnection();
+    void readMessage( QLocalSocket *socket );
+
 private:
     const QString key;
-    const QString memLockKey;
-    const QString sharedmemKey;
+    const QString serverName;
+    const QString lockFilePath;
 
-    QSharedMemory sharedMem;
-    QSystemSemaphore memLock;
+    QLockFile lockFile;
+    QLocalServer *server = nullptr;
 
     Q_DISABLE_COPY( RunGuard )
 };
@@ -0,0 +1,93 @@
+// Page side of PageBridge, injected into the application world before the
+// feature scripts. Provides window.whatsie:
+//   whatsie.send(type, payload[, {coalesce: true}])  page -> C++
+//   whatsie.on(type, function (payload) {})          C++ -> page
+// Outgoing messages are batched per animation frame (or every 100 ms while
+// the page is hidden and frames do not run) and sent as one versioned batch.
+(function () {
+    "use strict";
+
+    if (window.whatsie)
+        return;
+
+    var protocolVersion = 1;
+    var maxQueued = 256;
+    var hiddenFlushMs = 100;
+
+    var channelObject = null;
+    var queue = [];
+    var scheduled = false;
+    var handlers = {};
+    var dropped = 0;
+
+    function flush() {
+        scheduled = false;
+        if (!channelObject || queue.length === 0)
+            return;
+        var batch = { version: protocolVersion, dropped: dropped, messages: queue };
+        queue = [];
+        dropped = 0;
+        channelObject.receive(batch);
+    }
+
+    function schedule() {
+        if (scheduled)
+            return;
+        scheduled = true;
+        if (document.hidden || !window.requestAnimationFrame)
+            setTimeout(flush, hiddenFlushMs);
+        else
+            requestAnimationFrame(flush);
+    }
+
+    function send(type, payload, options) {
+        var message = { type: type, payload: payload, sentAt: Date.now() };
+        if (options && options.coalesce) {
+            for (var i = 0; i < queue.length; ++i) {
+                if (queue[i].type === type) {
+                    queue[i] = message;
+                    schedule();
+                    return;
+                }
+            }
+        }
+        if (queue.length >= maxQueued) {
+            queue.shift();
+            ++dropped;
+        }
+        queue.push(message);
+        schedule();
+    }
+
+    function on(type, handler) {
+        handlers[type] = handler;
+    }
+
+    function deliver(batch) {
+        if (batch.version !== protocolVersion) {
+            console.warn("whatsie: bridge version " + batch.version + ", expected " + protocolVersion);
+        } else {
+            var messages = batch.messages || [];
+            for (var i = 0; i < messages.length; ++i) {
+                var handler = handlers[messages[i].type];
+                if (handler) {
+                    try {
+                        handler(messages[i].payload);
+                    } catch (e) {
+                        console.warn("whatsie: handler for " + messages[i].type + " failed: " + e);
+                    }
+                }
+            }
+        }
+        channelObject.ack(batch.seq);
+    }
+
+    window.whatsie = { send: send, on: on };
+
+    new QWebChannel(qt.webChannelTransport, function (channel) {
+        channelObject = channel.objects.whatsiePageBridge;
+        channelObject.deliver.connect(deliver);
+        channelObject.hello(protocolVersion);
+        schedule();
+    });
+})();
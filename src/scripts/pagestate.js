@@ -0,0 +1,93 @@
+// Feature script of PageBridge (window.whatsie), see PageStateBridge.
+// Watches the DOM and sends a compact "state" message, debounced and only
+// when something changed. Applies the theme C++ asks for with "setTheme".
+(function () {
+    "use strict";
+
+    if (window.__whatsiePageState)
+        return;
+    window.__whatsiePageState = true;
+
+    var debounceMs = 250;
+    var timer = 0;
+    var lastSent = "";
+
+    function text(element) {
+        return element ? (element.getAttribute("title") || element.textContent || "") : "";
+    }
+
+    function chatRows() {
+        return document.querySelectorAll('#pane-side [role="row"], #pane-side [role="listitem"]');
+    }
+
+    function unreadOf(row) {
+        var badge = row.querySelector('[aria-label*="unread" i]');
+        if (!badge)
+            return 0;
+        var count = parseInt(badge.textContent, 10);
+        return isNaN(count) ? 1 : count;
+    }
+
+    function connectionState(rows) {
+        if (!navigator.onLine)
+            return "offline";
+        if (rows.length > 0)
+            return "connected";
+        if (document.querySelector("[data-ref] canvas, canvas[aria-label]"))
+            return "loggedOut";
+        return "connecting";
+    }
+
+    function collect() {
+        var rows = chatRows();
+        var chats = {};
+        var total = 0;
+        for (var i = 0; i < rows.length; ++i) {
+            var count = unreadOf(rows[i]);
+            if (count > 0) {
+                var name = text(rows[i].querySelector("span[title]"));
+                chats[name] = (chats[name] || 0) + count;
+                total += count;
+            }
+        }
+        return {
+            totalUnread: total,
+            chats: chats,
+            chatListRows: rows.length,
+            connection: connectionState(rows),
+            theme: document.body && document.body.classList.contains("dark") ? "dark" : "light",
+            activeChat: text(document.querySelector("#main header span[title]"))
+        };
+    }
+
+    function push() {
+        timer = 0;
+        var state = collect();
+        var serialized = JSON.stringify(state);
+        if (serialized === lastSent)
+            return;
+        lastSent = serialized;
+        whatsie.send("state", state, { coalesce: true });
+    }
+
+    function schedule() {
+        if (!timer)
+            timer = setTimeout(push, debounceMs);
+    }
+
+    whatsie.on("setTheme", function (className) {
+        if (document.body)
+            document.body.className = className;
+    });
+
+    new MutationObserver(schedule).observe(document.documentElement, {
+        childList: true,
+        subtree: true,
+        characterData: true,
+        attributes: true,
+        attributeFilter: ["class", "aria-label", "title"]
+    });
+    window.addEventListener("online", schedule);
+    window.addEventListener("offline", schedule);
+    schedule();
+})();
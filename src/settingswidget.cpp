@@ -6,6 +6,9 @@
 #include "mainwindow.h"
 
 #include "automatictheme.h"
+#include "chromiumflags.h"
+#include "downloadrules.h"
+#include "ui_downloadrulesdialog.h"
 
 
 extern QString defaultUserAgentStr;
@@ -31,8 +34,33 @@ SettingsWidget::SettingsWidget(QWidget *parent, QString engineCachePath, QString
     ui->userAgentLineEdit->setText(settings.value("useragent",defaultUserAgentStr).toString());
     ui->enableSpellCheck->setChecked(settings.value("sc_enabled",true).toBool());
     ui->notificationTimeOutspinBox->setValue(settings.value("notificationTimeOut",9000).toInt()/1000);
+#ifndef Q_OS_LINUX
+    // the D-Bus backend is only built on Linux
+    ui->notificationCombo->removeItem(2);
+#endif
     ui->notificationCombo->setCurrentIndex(settings.value("notificationCombo",1).toInt());
     ui->useNativeFileDialog->setChecked(settings.value("useNativeFileDialog",false).toBool());
+    ui->autoSaveDownloadsCheckBox->setChecked(settings.value("downloads/autoSave",false).toBool());
+    ui->maxConcurrentDownloadsSpinBox->setValue(settings.value("downloads/maxConcurrent",3).toInt());
+    ui->freezeAfterSpinBox->setValue(settings.value("lifecycle/freezeAfterMinutes",10).toInt());
+    ui->discardAfterSpinBox->setValue(settings.value("lifecycle/discardAfterMinutes",0).toInt());
+
+    ui->enginePresetComboBox->blockSignals(true);
+    foreach (const QString &preset, ChromiumFlags::presetNames()) {
+        ui->enginePresetComboBox->addItem(ChromiumFlags::presetTitle(preset),preset);
+    }
+    ui->enginePresetComboBox->setCurrentIndex(
+                ui->enginePresetComboBox->findData(ChromiumFlags::currentPreset()));
+    ui->enginePresetComboBox->blockSignals(false);
+    ui->customFlagsLineEdit->setText(ChromiumFlags::customFlags(ChromiumFlags::currentPreset()).join(" "));
+    QString presetToolTip = tr("Flags in use: %1")
+                .arg(QString::fromLocal8Bit(qgetenv("QTWEBENGINE_CHROMIUM_FLAGS")));
+    // set by CrashRecovery when a crash loop forced the low memory preset
+    const QString fallbackFrom = settings.value("crashRecovery/fallbackFrom").toString();
+    if(!fallbackFrom.isEmpty())
+        presetToolTip += "\n" + tr("Switched from %1 after repeated crashes, pick it again to go back.")
+                .arg(ChromiumFlags::presetTitle(fallbackFrom));
+    ui->enginePresetComboBox->setToolTip(presetToolTip);
 
     ui->automaticThemeCheckBox->blockSignals(true);
     bool automaticThemeSwitching = settings.value("automaticTheme",false).toBool();
@@ -170,6 +198,11 @@ void SettingsWidget::refresh()
 
 }
 
+void SettingsWidget::setLifecycleStats(QString stats)
+{
+    ui->lifecycleStatsLabel->setText(stats);
+}
+
 void SettingsWidget::updateDefaultUAButton(const QString engineUA)
 {
     bool isDefault = QString::compare(engineUA,defaultUserAgentStr,Qt::CaseInsensitive) == 0;
@@ -235,6 +268,7 @@ void SettingsWidget::on_deletePersistentData_clicked()
 void SettingsWidget::on_notificationCheckBox_toggled(bool checked)
 {
     settings.setValue("disableNotificationPopups",checked);
+    emit notificationSettingsChanged();
 }
 
 void SettingsWidget::on_themeComboBox_currentTextChanged(const QString &arg1)
@@ -390,12 +424,13 @@ void SettingsWidget::on_showPermissionsButton_clicked()
 void SettingsWidget::on_notificationTimeOutspinBox_valueChanged(int arg1)
 {
     settings.setValue("notificationTimeOut",arg1*1000);
-    emit notificationPopupTimeOutChanged();
+    emit notificationSettingsChanged();
 }
 
 void SettingsWidget::on_notificationCombo_currentIndexChanged(int index)
 {
     settings.setValue("notificationCombo",index);
+    emit notificationSettingsChanged();
 }
 
 void SettingsWidget::on_tryNotification_clicked()
@@ -430,6 +465,94 @@ void SettingsWidget::on_useNativeFileDialog_toggled(bool checked)
     settings.setValue("useNativeFileDialog",checked);
 }
 
+void SettingsWidget::on_autoSaveDownloadsCheckBox_toggled(bool checked)
+{
+    settings.setValue("downloads/autoSave",checked);
+}
+
+void SettingsWidget::on_downloadRulesButton_clicked()
+{
+    QDialog dialog(this);
+    dialog.setModal(true);
+    dialog.setWindowFlags(dialog.windowFlags() & ~Qt::WindowContextHelpButtonHint);
+
+    Ui::DownloadRulesDialog rulesDialog;
+    rulesDialog.setupUi(&dialog);
+    QTableWidget *table = rulesDialog.rulesTable;
+
+    // match and action are picked from a list, pattern and folder are typed
+    auto addRow = [=](const DownloadRules::Rule &rule){
+        const int row = table->rowCount();
+        table->insertRow(row);
+        QComboBox *match = new QComboBox(table);
+        match->addItem(tr("File type"),"mime");
+        match->addItem(tr("Chat"),"chat");
+        match->setCurrentIndex(rule.kind == DownloadRules::Rule::Chat ? 1 : 0);
+        table->setCellWidget(row,0,match);
+        table->setItem(row,1,new QTableWidgetItem(rule.pattern));
+        QComboBox *action = new QComboBox(table);
+        action->addItem(tr("Save"),"save");
+        action->addItem(tr("Ask"),"ask");
+        action->setCurrentIndex(rule.ask ? 1 : 0);
+        table->setCellWidget(row,2,action);
+        table->setItem(row,3,new QTableWidgetItem(rule.folder));
+    };
+    foreach (const DownloadRules::Rule &rule, DownloadRules::read(settings)) {
+        addRow(rule);
+    }
+    connect(rulesDialog.addRuleButton,&QPushButton::clicked,&dialog,[=](){
+        addRow(DownloadRules::Rule());
+        table->editItem(table->item(table->rowCount()-1,1));
+    });
+    connect(rulesDialog.removeRuleButton,&QPushButton::clicked,&dialog,[=](){
+        if(table->currentRow() >= 0)
+            table->removeRow(table->currentRow());
+    });
+
+    rulesDialog.priorityLineEdit->setText(settings.value("downloads/priority",
+                QStringList({"document","image","audio","video"})).toStringList().join(", "));
+    rulesDialog.duplicatesComboBox->addItem(tr("Keep both"),"keep");
+    rulesDialog.duplicatesComboBox->addItem(tr("Replace with a hard link"),"hardlink");
+    rulesDialog.duplicatesComboBox->addItem(tr("Delete the new copy"),"remove");
+    rulesDialog.duplicatesComboBox->setCurrentIndex(qMax(0,
+                rulesDialog.duplicatesComboBox->findData(settings.value("downloads/duplicates","keep"))));
+
+    if(dialog.exec() != QDialog::Accepted)
+        return;
+
+    QVector<DownloadRules::Rule> rules;
+    for(int row = 0; row < table->rowCount(); ++row){
+        DownloadRules::Rule rule;
+        auto match = qobject_cast<QComboBox*>(table->cellWidget(row,0));
+        auto action = qobject_cast<QComboBox*>(table->cellWidget(row,2));
+        rule.kind = match->currentData().toString() == "chat" ? DownloadRules::Rule::Chat
+                                                               : DownloadRules::Rule::MimeType;
+        rule.pattern = table->item(row,1) ? table->item(row,1)->text().trimmed() : QString();
+        rule.ask = action->currentData().toString() == "ask";
+        rule.folder = table->item(row,3) ? table->item(row,3)->text().trimmed() : QString();
+        // a rule without a pattern never matches, load() skips it anyway
+        if(!rule.pattern.isEmpty())
+            rules.append(rule);
+    }
+    DownloadRules::save(settings,rules);
+
+    QStringList priority;
+    foreach (const QString &kind, rulesDialog.priorityLineEdit->text().split(',',QString::SkipEmptyParts)) {
+        if(!kind.trimmed().isEmpty())
+            priority.append(kind.trimmed().toLower());
+    }
+    if(priority.isEmpty())
+        settings.remove("downloads/priority");
+    else
+        settings.setValue("downloads/priority",priority);
+    settings.setValue("downloads/duplicates",rulesDialog.duplicatesComboBox->currentData());
+}
+
+void SettingsWidget::on_maxConcurrentDownloadsSpinBox_valueChanged(int arg1)
+{
+    settings.setValue("downloads/maxConcurrent",arg1);
+}
+
 void SettingsWidget::on_zoomPlus_clicked()
 {
     double currentFactor = settings.value("zoomFactor",1.0).toDouble();
@@ -458,3 +581,51 @@ void SettingsWidget::on_zoomReset_clicked()
     settings.setValue("zoomFactor",ui->zoomFactorSpinBox->value());
     emit zoomChanged();
 }
+
+void SettingsWidget::on_freezeAfterSpinBox_valueChanged(int arg1)
+{
+    settings.setValue("lifecycle/freezeAfterMinutes",arg1);
+    emit lifecycleSettingsChanged();
+}
+
+void SettingsWidget::on_discardAfterSpinBox_valueChanged(int arg1)
+{
+    settings.setValue("lifecycle/discardAfterMinutes",arg1);
+    emit lifecycleSettingsChanged();
+}
+
+void SettingsWidget::on_enginePresetComboBox_currentIndexChanged(int index)
+{
+    QString preset = ui->enginePresetComboBox->itemData(index).toString();
+    settings.setValue("engine/preset",preset);
+    // the user chose a preset, it is no longer a crash fallback
+    settings.remove("crashRecovery/fallbackFrom");
+    ui->customFlagsLineEdit->setText(ChromiumFlags::customFlags(preset).join(" "));
+    askToRestart();
+}
+
+void SettingsWidget::on_setCustomFlags_clicked()
+{
+    QString preset = ui->enginePresetComboBox->currentData().toString();
+    settings.setValue("engine/customFlags/"+preset,ui->customFlagsLineEdit->text().simplified());
+    askToRestart();
+}
+
+void SettingsWidget::askToRestart()
+{
+    QMessageBox msgBox;
+    msgBox.setWindowTitle(QApplication::applicationName()+" | Action required");
+    msgBox.setText("Engine settings are applied when the application starts.");
+    msgBox.setIconPixmap(QPixmap(":/icons/information-line.png").scaled(42,42,Qt::KeepAspectRatio,Qt::SmoothTransformation));
+    msgBox.setInformativeText("Restart application now ?");
+    msgBox.setStandardButtons(QMessageBox::Yes | QMessageBox::No);
+    msgBox.setDefaultButton(QMessageBox::No);
+    if(msgBox.exec() == QMessageBox::Yes){
+        emit restartRequested();
+    }
+}
+
+void SettingsWidget::on_showResourceMonitorButton_clicked()
+{
+    emit showResourceMonitor();
+}
@@ -26,9 +26,12 @@ signals:
     void init_lock();
     void dictChanged(QString dict);
     void spellCheckChanged(bool checked);
-    void notificationPopupTimeOutChanged();
+    void notificationSettingsChanged();
     void notify(QString message);
     void zoomChanged();
+    void lifecycleSettingsChanged();
+    void restartRequested();
+    void showResourceMonitor();
 
 public:
     explicit SettingsWidget(QWidget *parent = nullptr,QString engineCachePath = "",
@@ -41,6 +44,7 @@ public slots:
     void appLockSetChecked(bool checked);
     void setCurrentPasswordText(QString str);
     void loadDictionaries(QStringList dictionaries);
+    void setLifecycleStats(QString stats);
 private slots:
     QString cachePath();
     QString persistentStoragePath();
@@ -89,11 +93,25 @@ private slots:
     void themeSwitchTimerTimeout();
     void on_useNativeFileDialog_toggled(bool checked);
 
+    void on_autoSaveDownloadsCheckBox_toggled(bool checked);
+    void on_downloadRulesButton_clicked();
+
+    void on_maxConcurrentDownloadsSpinBox_valueChanged(int arg1);
+
     void on_zoomPlus_clicked();
     void on_zoomMinus_clicked();
 
     void on_zoomReset_clicked();
 
+    void on_freezeAfterSpinBox_valueChanged(int arg1);
+    void on_discardAfterSpinBox_valueChanged(int arg1);
+
+    void on_enginePresetComboBox_currentIndexChanged(int index);
+    void on_setCustomFlags_clicked();
+    void askToRestart();
+
+    void on_showResourceMonitorButton_clicked();
+
 private:
     Ui::SettingsWidget *ui;
     QString engineCachePath,enginePersistentStoragePath;
@@ -0,0 +1,153 @@
+#include "startuptracer.h"
+
+#include <QCoreApplication>
+#include <QDebug>
+#include <QElapsedTimer>
+#include <QFile>
+#include <QJsonArray>
+#include <QJsonDocument>
+#include <QJsonObject>
+#include <QTimer>
+#include <QVector>
+
+namespace
+{
+    struct TraceEvent
+    {
+        const char *name;
+        char phase;
+        qint64 timestamp; // microseconds since init()
+        QString detail;
+    };
+
+    struct TraceState
+    {
+        bool enabled = false;
+        bool finished = false;
+        QString outputPath;
+        QElapsedTimer clock;
+        QVector<TraceEvent> events;
+    };
+
+    TraceState &state()
+    {
+        static TraceState s;
+        return s;
+    }
+
+    void record(const char *name, char phase, const QString &detail = QString())
+    {
+        TraceState &s = state();
+        if (!s.enabled || s.finished)
+            return;
+        s.events.append({name, phase, s.clock.nsecsElapsed() / 1000, detail});
+    }
+
+    // gives up on the chat list after this long so the trace is always written
+    const int chatListTimeoutMs = 120000;
+}
+
+void StartupTracer::init(int argc, char *argv[])
+{
+    static const QByteArray option("--trace-startup=");
+    for (int i = 1; i < argc; ++i) {
+        const QByteArray arg(argv[i]);
+        if (arg.startsWith(option)) {
+            TraceState &s = state();
+            s.outputPath = QString::fromLocal8Bit(arg.mid(option.size()));
+            s.enabled = !s.outputPath.isEmpty();
+            s.events.reserve(64);
+            s.clock.start();
+            break;
+        }
+    }
+}
+
+bool StartupTracer::isEnabled()
+{
+    return state().enabled && !state().finished;
+}
+
+void StartupTracer::begin(const char *name)
+{
+    record(name, 'B');
+}
+
+void StartupTracer::end(const char *name)
+{
+    record(name, 'E');
+}
+
+void StartupTracer::instant(const char *name, const QString &detail)
+{
+    record(name, 'i', detail);
+}
+
+void StartupTracer::waitForChatList()
+{
+    if (!isEnabled())
+        return;
+
+    QTimer::singleShot(chatListTimeoutMs, []()
+    {
+        if (isEnabled()) {
+            instant("chatListTimeout");
+            finish();
+        }
+    });
+}
+
+void StartupTracer::chatListShown(int rows)
+{
+    if (!isEnabled())
+        return;
+    instant("firstChatList", QString::number(rows) + " rows");
+    finish();
+}
+
+void StartupTracer::finish()
+{
+    TraceState &s = state();
+    if (!s.enabled || s.finished)
+        return;
+    s.finished = true;
+
+    const qint64 pid = QCoreApplication::applicationPid();
+
+    QJsonArray traceEvents;
+    QJsonObject processName;
+    processName.insert("name", "process_name");
+    processName.insert("ph", "M");
+    processName.insert("pid", pid);
+    processName.insert("tid", 1);
+    processName.insert("args", QJsonObject{{"name", "whatsie"}});
+    traceEvents.append(processName);
+
+    for (const TraceEvent &event : s.events) {
+        QJsonObject obj;
+        obj.insert("name", QString::fromLatin1(event.name));
+        obj.insert("cat", "startup");
+        obj.insert("ph", QString(QChar::fromLatin1(event.phase)));
+        obj.insert("ts", event.timestamp);
+        obj.insert("pid", pid);
+        obj.insert("tid", 1);
+        if (event.phase == 'i')
+            obj.insert("s", "p");
+        if (!event.detail.isEmpty())
+            obj.insert("args", QJsonObject{{"detail", event.detail}});
+        traceEvents.append(obj);
+    }
+
+    QJsonObject root;
+    root.insert("traceEvents", traceEvents);
+    root.insert("displayTimeUnit", "ms");
+
+    QFile file(s.outputPath);
+    if (!file.open(QIODevice::WriteOnly | QIODevice::Truncate)) {
+        qWarning() << "StartupTracer: unable to write" << s.outputPath << file.errorString();
+        return;
+    }
+    file.write(QJsonDocument(root).toJson(QJsonDocument::Compact));
+    qWarning() << "StartupTracer: wrote" << s.events.size() << "events to" << s.outputPath;
+    s.events.clear();
+}
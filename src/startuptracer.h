@@ -0,0 +1,40 @@
+#ifndef STARTUPTRACER_H
+#define STARTUPTRACER_H
+
+#include <QString>
+
+// Records startup phases and writes them as Chrome trace-event JSON
+// (load the file in chrome://tracing or https://ui.perfetto.dev).
+// Enabled with --trace-startup=<file>, all calls are no-ops otherwise.
+class StartupTracer
+{
+public:
+    // Must be the first thing called in main(), before QApplication.
+    static void init(int argc, char *argv[]);
+    static bool isEnabled();
+
+    static void begin(const char *name);
+    static void end(const char *name);
+    static void instant(const char *name, const QString &detail = QString());
+
+    // Starts waiting for chatListShown(), the trace is written after a timeout otherwise.
+    static void waitForChatList();
+    // The chat list got its first rows (PageStateBridge), records it and writes the trace.
+    static void chatListShown(int rows);
+
+    // Writes the trace file, only the first call has any effect.
+    static void finish();
+
+    // Records a complete phase for the lifetime of the object.
+    class Scope
+    {
+    public:
+        explicit Scope(const char *name) : m_name(name) { StartupTracer::begin(m_name); }
+        ~Scope() { StartupTracer::end(m_name); }
+    private:
+        const char *m_name;
+        Q_DISABLE_COPY(Scope)
+    };
+};
+
+#endif // STARTUPTRACER_H
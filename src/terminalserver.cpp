@@ -0,0 +1,52 @@
+#include "terminalserver.h"
+
+#include <QDebug>
+#include <QSettings>
+
+namespace
+{
+    bool terminalServerEnabled = false;
+}
+
+void TerminalServerMode::init(int argc, char *argv[])
+{
+    QSettings settings;
+
+    terminalServerEnabled = settings.value("terminalServer/enabled",false).toBool()
+            || qEnvironmentVariableIntValue("WHATSIE_TERMINAL_SERVER") == 1;
+    for (int i = 1; i < argc && !terminalServerEnabled; ++i) {
+        if (qstrcmp(argv[i], "--terminal-server") == 0)
+            terminalServerEnabled = true;
+    }
+
+    if (terminalServerEnabled)
+        qWarning() << "Terminal server mode enabled";
+}
+
+QStringList TerminalServerMode::chromiumFlags()
+{
+    QStringList flags;
+    if (!terminalServerEnabled)
+        return flags;
+
+    QSettings settings;
+    int rendererLimit = qMax(1, settings.value("terminalServer/rendererProcessLimit",1).toInt());
+
+    flags << "--renderer-process-limit=" + QString::number(rendererLimit)
+          << "--process-per-site"
+          // no GPU on terminal servers, don't spawn a GPU process per user
+          << "--disable-gpu"
+          << "--disable-gpu-compositing";
+    return flags;
+}
+
+bool TerminalServerMode::isEnabled()
+{
+    return terminalServerEnabled;
+}
+
+int TerminalServerMode::httpCacheMaximumSize()
+{
+    QSettings settings;
+    return qMax(1, settings.value("terminalServer/cacheSizeMB",50).toInt()) * 1024 * 1024;
+}
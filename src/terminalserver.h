@@ -0,0 +1,27 @@
+#ifndef TERMINALSERVER_H
+#define TERMINALSERVER_H
+
+#include <QStringList>
+
+// Terminal-server mode for hosts shared by many users (Xrdp/VNC).
+// Caps the number of renderer processes, skips the GPU process and bounds
+// the HTTP cache of each instance.
+//
+// Enabled by --terminal-server, WHATSIE_TERMINAL_SERVER=1 or the
+// "terminalServer/enabled" setting.
+class TerminalServerMode
+{
+public:
+    // Must be called in main() before QApplication is constructed,
+    // after the organization and application names are set.
+    static void init(int argc, char *argv[]);
+    static bool isEnabled();
+
+    // Passed on to ChromiumFlags::apply(), empty when disabled.
+    static QStringList chromiumFlags();
+
+    // Bytes, applied to the web profile.
+    static int httpCacheMaximumSize();
+};
+
+#endif // TERMINALSERVER_H
@@ -0,0 +1,46 @@
+#include "transferrate.h"
+
+namespace
+{
+    // shorter spans give jumpy numbers
+    const qint64 minimumSpanMs = 500;
+}
+
+TransferRate::TransferRate(qint64 windowMs)
+    : m_windowMs(windowMs)
+{
+}
+
+void TransferRate::addSample(qint64 timeMs, qint64 bytes)
+{
+    // a restarted transfer starts over
+    if (!m_samples.empty() && bytes < m_samples.back().bytes)
+        m_samples.clear();
+    m_samples.push_back({timeMs, bytes});
+    // keep one sample older than the window, so the window is always covered
+    while (m_samples.size() > 2 && timeMs - m_samples[1].timeMs >= m_windowMs)
+        m_samples.pop_front();
+}
+
+void TransferRate::reset()
+{
+    m_samples.clear();
+}
+
+qreal TransferRate::bytesPerSecond() const
+{
+    if (m_samples.size() < 2)
+        return -1;
+    const qint64 span = m_samples.back().timeMs - m_samples.front().timeMs;
+    if (span < minimumSpanMs)
+        return -1;
+    return (m_samples.back().bytes - m_samples.front().bytes) * 1000.0 / span;
+}
+
+qint64 TransferRate::secondsLeft(qint64 remainingBytes) const
+{
+    const qreal speed = bytesPerSecond();
+    if (speed <= 0 || remainingBytes < 0)
+        return -1;
+    return qint64(remainingBytes / speed + 0.5);
+}
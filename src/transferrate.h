@@ -0,0 +1,34 @@
+#ifndef TRANSFERRATE_H
+#define TRANSFERRATE_H
+
+#include <QtGlobal>
+
+#include <deque>
+
+// Transfer speed over the last few seconds of (time, bytes) samples, so a
+// stall or a burst shows up quickly and time spent before the transfer
+// started (e.g. in a Save As dialog) never counts.
+class TransferRate
+{
+public:
+    explicit TransferRate(qint64 windowMs = 5000);
+
+    void addSample(qint64 timeMs, qint64 bytes);
+    void reset();
+
+    // -1 while the window spans too little time to tell
+    qreal bytesPerSecond() const;
+    // seconds until remainingBytes are done at the current speed, -1 if unknown
+    qint64 secondsLeft(qint64 remainingBytes) const;
+
+private:
+    struct Sample {
+        qint64 timeMs;
+        qint64 bytes;
+    };
+
+    qint64 m_windowMs;
+    std::deque<Sample> m_samples;
+};
+
+#endif // TRANSFERRATE_H
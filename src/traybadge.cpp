@@ -0,0 +1,95 @@
+#include "traybadge.h"
+
+#include <QFont>
+#include <QPainter>
+#include <QPixmap>
+
+namespace
+{
+    const int maxShownCount = 100;   // 100 and above is drawn as "99+"
+    const int cachedIcons   = 24;
+    const int iconSizes[]   = { 16, 22, 24, 32, 48, 64 };
+}
+
+int parseUnreadCount(const QString &title)
+{
+    // "(<count>) ..." with a count that does not start with 0
+    const int size = title.size();
+    if (size < 3 || title.at(0) != QLatin1Char('('))
+        return 0;
+
+    const QChar *data = title.constData();
+    int count = 0;
+    int i = 1;
+    if (data[i] < QLatin1Char('1') || data[i] > QLatin1Char('9'))
+        return 0;
+    for (; i < size && data[i].isDigit(); ++i) {
+        if (count < 1000000)
+            count = count * 10 + data[i].digitValue();
+    }
+    if (i == size || data[i] != QLatin1Char(')'))
+        return 0;
+    return count;
+}
+
+TrayBadgeRenderer::TrayBadgeRenderer(const QIcon &readIcon, const QIcon &unreadIcon)
+    : m_readIcon(readIcon),
+      m_unreadIcon(unreadIcon),
+      m_cache(cachedIcons)
+{
+}
+
+QIcon TrayBadgeRenderer::icon(int unreadCount, bool darkTheme)
+{
+    if (unreadCount <= 0)
+        return m_readIcon;
+
+    unreadCount = qMin(unreadCount, maxShownCount);
+    const quint32 key = quint32(unreadCount) << 1 | (darkTheme ? 1 : 0);
+    if (QIcon *cached = m_cache.object(key)) {
+        ++m_hits;
+        return *cached;
+    }
+
+    ++m_misses;
+    QIcon *rendered = new QIcon(render(unreadCount, darkTheme));
+    QIcon result = *rendered;
+    m_cache.insert(key, rendered);
+    return result;
+}
+
+QIcon TrayBadgeRenderer::render(int unreadCount, bool darkTheme) const
+{
+    const QString text = unreadCount >= maxShownCount ? QStringLiteral("99+")
+                                                      : QString::number(unreadCount);
+    QIcon badged;
+    for (int size : iconSizes) {
+        QPixmap pixmap = m_unreadIcon.pixmap(size, size);
+        if (pixmap.isNull())
+            continue;
+
+        QPainter painter(&pixmap);
+        painter.setRenderHint(QPainter::Antialiasing);
+        painter.setRenderHint(QPainter::TextAntialiasing);
+
+        // badge in the top right corner, wider for more digits
+        const qreal height = size * 0.55;
+        const qreal width = qMax(height, height * 0.45 * (text.size() + 0.6));
+        const QRectF badge(size - width, 0, width, height);
+
+        painter.setPen(QPen(darkTheme ? QColor("#131C21") : QColor("#F0F0F0"), qMax(1.0, size / 22.0)));
+        painter.setBrush(QColor("#E53935"));
+        painter.drawRoundedRect(badge, height / 2, height / 2);
+
+        QFont font = painter.font();
+        font.setBold(true);
+        font.setPixelSize(qMax(6, int(height * (text.size() > 2 ? 0.55 : 0.7))));
+        painter.setFont(font);
+        painter.setPen(Qt::white);
+        painter.drawText(badge, Qt::AlignCenter, text);
+        painter.end();
+
+        badged.addPixmap(pixmap);
+    }
+    return badged;
+}
@@ -0,0 +1,35 @@
+#ifndef TRAYBADGE_H
+#define TRAYBADGE_H
+
+#include <QCache>
+#include <QIcon>
+#include <QString>
+
+// Unread count from a WhatsApp Web title like "(3) WhatsApp".
+// Returns 0 when the title carries no count. Does not allocate.
+int parseUnreadCount(const QString &title);
+
+// Tray and window icons with the unread count drawn as a badge.
+// Rendering is done once per (count, theme), later requests are served
+// from a small LRU cache, counts above 99 share the "99+" icon.
+class TrayBadgeRenderer
+{
+public:
+    TrayBadgeRenderer(const QIcon &readIcon, const QIcon &unreadIcon);
+
+    QIcon icon(int unreadCount, bool darkTheme);
+
+    int cacheHits() const { return m_hits; }
+    int cacheMisses() const { return m_misses; }
+
+private:
+    QIcon render(int unreadCount, bool darkTheme) const;
+
+    QIcon m_readIcon;
+    QIcon m_unreadIcon;
+    QCache<quint32, QIcon> m_cache;
+    int m_hits = 0;
+    int m_misses = 0;
+};
+
+#endif // TRAYBADGE_H
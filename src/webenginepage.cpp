@@ -3,8 +3,21 @@
 #include <QIcon>
 #include <QStyle>
 #include <QWebEngineSettings>
+#include <ctime>
 
 
+QUrl WebEnginePage::homeUrl()
+{
+    return QUrl("https://web.whatsapp.com/");
+}
+
+QUrl WebEnginePage::cacheBustedHomeUrl()
+{
+    qsrand(time(NULL));
+    auto randomValue = qrand() % 300;
+    return QUrl("https://web.whatsapp.com/?v="+QString::number(randomValue));
+}
+
 WebEnginePage::WebEnginePage(QWebEngineProfile *profile, QObject *parent)
     : QWebEnginePage(profile, parent)
 {
@@ -28,6 +28,11 @@ class WebEnginePage : public QWebEnginePage
 public:
     WebEnginePage(QWebEngineProfile *profile, QObject *parent = nullptr);
 
+    // the url the app normally starts with, served by the service worker and http cache
+    static QUrl homeUrl();
+    // home url with a random query, forces a fresh copy of the page shell
+    static QUrl cacheBustedHomeUrl();
+
 private:
     QSettings settings;
 protected:
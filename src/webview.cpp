@@ -21,28 +21,6 @@ WebView::WebView(QWidget *parent, QStringList dictionaries)
             mainWindow, &MainWindow::handleWebViewTitleChanged);
     connect(this, &WebView::loadFinished,
             mainWindow, &MainWindow::handleLoadFinished);
-    connect(this, &WebView::renderProcessTerminated,
-            [this](QWebEnginePage::RenderProcessTerminationStatus termStatus, int statusCode) {
-        QString status;
-        switch (termStatus) {
-        case QWebEnginePage::NormalTerminationStatus:
-            status = tr("Render process normal exit");
-            break;
-        case QWebEnginePage::AbnormalTerminationStatus:
-            status = tr("Render process abnormal exit");
-            break;
-        case QWebEnginePage::CrashedTerminationStatus:
-            status = tr("Render process crashed");
-            break;
-        case QWebEnginePage::KilledTerminationStatus:
-            status = tr("Render process killed");
-            break;
-        }
-        QMessageBox::StandardButton btn = QMessageBox::question(window(), status,
-                                                   tr("Render process exited with code: %1\n"                                            "Do you want to reload the page ?").arg(statusCode));
-        if (btn == QMessageBox::Yes)
-            QTimer::singleShot(0, [this] { this->reload(); });
-    });
 }
 
 
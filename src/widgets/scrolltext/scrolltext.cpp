@@ -2,6 +2,14 @@
 #include <QPainter>
 #include <QHoverEvent>
 
+namespace
+{
+    // pixels per second, what the old 2px / 50ms timer scrolled
+    const int scrollSpeed = 40;
+    // scrolling starts this far "before" the text, a short delay
+    const int startDelayPixels = 64;
+}
+
 ScrollText::ScrollText(QWidget *parent) :
     QWidget(parent), scrollPos(0)
 {
@@ -17,8 +25,7 @@ ScrollText::ScrollText(QWidget *parent) :
 
     setSeparator("        ");
 
-    connect(&timer, SIGNAL(timeout()), this, SLOT(timer_timeout()));
-    timer.setInterval(50);
+    connect(&animation, &QVariantAnimation::valueChanged, this, &ScrollText::animation_valueChanged);
 }
 
 QString ScrollText::text() const
@@ -53,23 +60,42 @@ void ScrollText::setLeftMargin(int pixels)
 
 void ScrollText::pause()
 {
-    if(scrollEnabled){
-        timer.stop();
+    if(scrollEnabled && animation.state() == QAbstractAnimation::Running){
+        animation.pause();
     }
 }
 
 void ScrollText::resume()
 {
-    if(scrollEnabled){
-        timer.start();
-        scrolledOnce = false;
-    }
+    if(scrollEnabled == false)
+        return;
+    pausedByHide = false;
+    if(animation.state() == QAbstractAnimation::Paused)
+        animation.resume();
+    else if(animation.state() == QAbstractAnimation::Stopped)
+        // one more rotation, 0 looks the same as the end of the last one
+        startScrolling(0);
+}
+
+void ScrollText::startScrolling(int from)
+{
+    scrollPos = from;
+    animation.stop();
+    animation.setStartValue(from);
+    animation.setEndValue(wholeTextSize.width());
+    animation.setDuration(qMax(1, (wholeTextSize.width() - from) * 1000 / scrollSpeed));
+    // hidden widgets don't animate, showEvent() starts it
+    if(isVisible())
+        animation.start();
+    else
+        pausedByHide = true;
 }
 
 void ScrollText::updateText()
 {
-    scrolledOnce = false;
-    timer.stop();
+    animation.stop();
+    pausedByHide = false;
+    strip = QImage();
 
     singleTextWidth = fontMetrics().horizontalAdvance(_text);
 //    scrollEnabled = true;
@@ -77,9 +103,7 @@ void ScrollText::updateText()
 
     if(scrollEnabled)
     {
-        scrollPos = -64;
         staticText.setText(_text + _separator);
-        timer.start();
     }
     else{
         staticText.setText(_text);
@@ -88,6 +112,22 @@ void ScrollText::updateText()
     //wholeTextSize = QSize(fontMetrics().width(staticText.text()), fontMetrics().height());
     wholeTextSize = QSize(fontMetrics().horizontalAdvance(staticText.text()), fontMetrics().height());
 
+    if(scrollEnabled)
+        startScrolling(-startDelayPixels);
+}
+
+const QImage &ScrollText::textStrip()
+{
+    if(strip.isNull() && wholeTextSize.width() > 0 && height() > 0)
+    {
+        strip = QImage(wholeTextSize.width(), height(), QImage::Format_ARGB32_Premultiplied);
+        strip.fill(Qt::transparent);
+        QPainter ps(&strip);
+        ps.setPen(palette().color(foregroundRole()));
+        ps.setFont(font());
+        ps.drawStaticText(QPointF(0, (height() - wholeTextSize.height()) / 2) + QPoint(2, 2), staticText);
+    }
+    return strip;
 }
 
 void ScrollText::paintEvent(QPaintEvent*)
@@ -96,16 +136,18 @@ void ScrollText::paintEvent(QPaintEvent*)
 
     if(scrollEnabled)
     {
-        buffer.fill(qRgba(0, 0, 0, 0));
+        const QImage &tile = textStrip();
         QPainter pb(&buffer);
-        pb.setPen(p.pen());
-        pb.setFont(p.font());
+        // the tiles cover the buffer, no need to clear it first
+        pb.setCompositionMode(QPainter::CompositionMode_Source);
 
         int x = qMin(-scrollPos, 0) + leftMargin;
-        while(x < width())
+        if(x > 0)
+            pb.fillRect(0, 0, x, height(), Qt::transparent);
+        while(x < width() && tile.isNull() == false)
         {
-            pb.drawStaticText(QPointF(x, (height() - wholeTextSize.height()) / 2) + QPoint(2, 2), staticText);
-            x += wholeTextSize.width();
+            pb.drawImage(x, 0, tile);
+            x += tile.width();
         }
 
         //Apply Alpha Channel
@@ -117,6 +159,7 @@ void ScrollText::paintEvent(QPaintEvent*)
         if(scrollPos < 0)
             pb.setOpacity((qreal)(qMax(-8, scrollPos) + 8) / 8.0);
         pb.drawImage(0, 0, alphaChannel);
+        pb.end();
         p.drawImage(0, 0, buffer);
     }
     else
@@ -128,10 +171,24 @@ void ScrollText::paintEvent(QPaintEvent*)
 
 void ScrollText::resizeEvent(QResizeEvent*)
 {
-    //When the widget is resized, we need to update the alpha channel.
+    //pooled popups keep their size, only reallocate when it really changed
+    if(buffer.size() != size())
+    {
+        if(strip.height() != height())
+            strip = QImage();
+        buffer = QImage(size(), QImage::Format_ARGB32_Premultiplied);
+        updateAlphaChannel();
+    }
+
+    //Update scrolling state
+    bool newScrollEnabled = (singleTextWidth > width() - leftMargin);
+    if(newScrollEnabled != scrollEnabled)
+        updateText();
+}
 
+void ScrollText::updateAlphaChannel()
+{
     alphaChannel = QImage(size(), QImage::Format_ARGB32_Premultiplied);
-    buffer = QImage(size(), QImage::Format_ARGB32_Premultiplied);
 
     //Create Alpha Channel:
     if(width() > 64)
@@ -148,32 +205,48 @@ void ScrollText::resizeEvent(QResizeEvent*)
     }
     else
         alphaChannel.fill(qRgb(0, 0, 0));
-
-
-    //Update scrolling state
-    bool newScrollEnabled = (singleTextWidth > width() - leftMargin);
-    if(newScrollEnabled != scrollEnabled)
-        updateText();
 }
 
-void ScrollText::timer_timeout()
+void ScrollText::showEvent(QShowEvent *event)
 {
-    scrollPos = (scrollPos + 2)
-                % wholeTextSize.width();
-    pauseAfterOneRotation(scrollPos);
-    update();
+    QWidget::showEvent(event);
+    if(scrollEnabled && pausedByHide)
+    {
+        pausedByHide = false;
+        if(animation.state() == QAbstractAnimation::Paused)
+            animation.resume();
+        else
+            animation.start();
+    }
 }
 
-void ScrollText::pauseAfterOneRotation(int scrollPos)
+void ScrollText::hideEvent(QHideEvent *event)
 {
-    if(scrolledOnce == false && scrollPos+2==wholeTextSize.width()){
-        scrolledOnce = true;
-    }
-    if(scrolledOnce){
-        pause();
+    QWidget::hideEvent(event);
+    if(animation.state() == QAbstractAnimation::Running)
+    {
+        animation.pause();
+        pausedByHide = true;
     }
 }
 
+void ScrollText::changeEvent(QEvent *event)
+{
+    QWidget::changeEvent(event);
+    if(event->type() == QEvent::FontChange)
+        updateText();
+    else if(event->type() == QEvent::PaletteChange){
+        strip = QImage();
+        update();
+    }
+}
 
-
-
+void ScrollText::animation_valueChanged(const QVariant &value)
+{
+    // the animation ticks every frame, repaint only when the text moved a pixel
+    const int newScrollPos = value.toInt() % qMax(1, wholeTextSize.width());
+    if(newScrollPos == scrollPos)
+        return;
+    scrollPos = newScrollPos;
+    update();
+}
@@ -3,7 +3,7 @@
 
 #include <QWidget>
 #include <QStaticText>
-#include <QTimer>
+#include <QVariantAnimation>
 
 
 class ScrollText : public QWidget
@@ -29,9 +29,16 @@ public slots:
 protected:
     virtual void paintEvent(QPaintEvent *);
     virtual void resizeEvent(QResizeEvent *);
+    virtual void showEvent(QShowEvent *);
+    virtual void hideEvent(QHideEvent *);
+    virtual void changeEvent(QEvent *);
 
 private:
     void updateText();
+    void updateAlphaChannel();
+    void startScrolling(int from);
+    // text + separator rasterized once, blitted at an offset while scrolling
+    const QImage &textStrip();
     QString _text;
     QString _separator;
     QStaticText staticText;
@@ -42,12 +49,13 @@ private:
     int scrollPos;
     QImage alphaChannel;
     QImage buffer;
-    QTimer timer;
-    bool scrolledOnce = false;
+    QImage strip;
+    // frame synced, runs one rotation and stops
+    QVariantAnimation animation;
+    bool pausedByHide = false;
 
 private slots:
-    virtual void timer_timeout();
-    void pauseAfterOneRotation(int scrollPos);
+    void animation_valueChanged(const QVariant &value);
 };
 
 #endif // SCROLLTEXT_H